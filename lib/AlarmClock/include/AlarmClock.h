@@ -7,11 +7,14 @@
 
 // external third party libraries
 #include <array>
+#include <atomic>
+#include <cstring>
 #include <utility>
 #include <vector>
 #include <memory>
 #include <esp_sntp.h>
 #include <Arduino.h>
+#include <freertos/event_groups.h>
 #include <Preferences.h>
 #include <Wire.h>
 #include "RTClib.h"
@@ -19,29 +22,40 @@
 #include <WiFi.h>
 #include "AsyncTCP.h"
 #include "ESPAsyncWebServer.h"
-#include "AsyncJson.h"
+#include <ArduinoJson.h>
 #include "AsyncElegantOTA.h"
-#include "DFRobotDFPlayerMini.h"
 // external first party libraries
 #include "Matrix32x8.h"
 #include "BH1750_LightSensor.h"
 #include "ESP32_Touchpad.h"
 #include "ESP32_SimpleLEDC.h"
 #include "ESP32_Timer.h"
+#include "ESP32_I2CBus.h"
+#include "DFPlayerAsync.h"
 #include "UserInterface.h"
 // internal classes and headers
 #include "constants.h"
+#include "i2c.h"
+#include "scheduler.h"
+#include "timebase.h"
 #include "Bean.hpp"
+#include "SeqLock.hpp"
 #include "MainLight.hpp"
 #include "Sound.hpp"
 #include "Player.hpp"
+#include "ShuffleBag.hpp"
+#include "MemoryStream.hpp"
+#include "SoundCatalog.hpp"
+#include "ApiDocument.hpp"
 #include "alarm.h"
 #include "AlarmClock.hpp"
 // internal functions
 #include "bitmaps.h"
+#include "profiler.h"
 #include "navigation.h"
 #include "rtc_ds3231.h"
 #include "esp32_wifi.h"
+#include "commands.h"
 #include "webserver.h"
 #include "alarm_handler.h"
 #include "ui_frames.h"
@@ -10,17 +10,18 @@ namespace AlarmClock {
 
     struct {
 
-        volatile bool anyAlarmTriggered{false};
         float lightLevel{0.0f};
         bool uiActive{false};
-        DateTime now{};
+        SeqLock<DateTime> now{};
         std::array<uint8_t, 6> defuseCode{};
-        std::vector<Sound> sounds{};
+        SoundCatalog sounds{preferences};
         Alarm alarm1{N::ONE, preferences};
         Alarm alarm2{N::TWO, preferences};
         uint8_t snoozeTime{0};
         N alarmToSet{N::ONE};
-        StringBean tz{"timeZone", preferences};
+        uint16_t soundToSet{0}; // the sound selected in the player's sound frames, as the ui cursor ends at 255
+        StringBean tz{"timeZone", preferences}; // only accessed by the main loop
+        SeqLock<std::array<char, TIME_ZONE_MAX_LENGTH + 1>> timeZone{}; // a copy of tz for the other tasks
         Preferences preferences{};
         RTC_DS3231 rtc{};
         AsyncWebServer server{SERVER_PORT};
@@ -28,23 +29,33 @@ namespace AlarmClock {
         LEDC indicatorLight{INDICATOR_LED_PIN, LEDC::Resolution::BITS_8};
         MainLight mainLight{preferences};
         Matrix32x8 matrix{SPI_CS_PIN, [this]() {
-            return numToStr(now.hour()) + ':' +
-                   numToStr(now.minute()) + " " +
-                   numToStr(now.second(), 2, true);
+            auto dt = now.load();
+            return numToStr(dt.hour()) + ':' +
+                   numToStr(dt.minute()) + " " +
+                   numToStr(dt.second(), 2, true);
         }, [this]() {
             char dateStr[] = " DD. MMM";
-            now.toString(dateStr);
+            now.load().toString(dateStr);
             return std::string{dateStr};
         }};
         Player player{preferences};
-        UIDisplay ui{OLED_ADDRESS, I2C_SDA_PIN, I2C_SCL_PIN};
+        UIDisplay ui{i2c::oled, I2C_SDA_PIN, I2C_SCL_PIN};
         const ESP32_Timer uiTimer{
                 "UI Timer",
                 15000,
                 false,
-                [this]() { ui.transitionToFrame(0); }
+                []() { scheduler::notify(scheduler::UI_TIMEOUT); } // the display is only accessed by the main loop
         };
 
+        /**
+         * Copies the time zone for the other tasks; must be called by the main loop whenever tz is loaded or set
+         */
+        void publishTimeZone() {
+            std::array<char, TIME_ZONE_MAX_LENGTH + 1> zone{};
+            strncpy(zone.data(), ((String) tz).c_str(), TIME_ZONE_MAX_LENGTH);
+            timeZone = zone;
+        }
+
     } AC{};
 
 }
@@ -0,0 +1,107 @@
+#ifndef ALARM_CLOCK_API_DOCUMENT_HPP
+#define ALARM_CLOCK_API_DOCUMENT_HPP
+
+
+namespace AlarmClock {
+
+    /**
+     * @brief The document of a response of the web API, sent as JSON or as MessagePack if the client accepts it\n
+     * Used like the AsyncJsonResponse: the root is filled and the response is sent.
+     */
+    class DocumentResponse {
+
+        AsyncWebServerRequest *request;
+        DynamicJsonDocument doc;
+        JsonVariant root;
+
+    public:
+
+        /**
+         * @brief Checks whether the client of the given request accepts MessagePack
+         * @param request The request
+         * @return true if MessagePack is accepted, false if JSON is sent
+         */
+        static bool acceptsMsgPack(AsyncWebServerRequest *request) {
+            return request->hasHeader("Accept") && request->getHeader("Accept")->value().indexOf("msgpack") >= 0;
+        }
+
+        explicit DocumentResponse(AsyncWebServerRequest *request, size_t capacity = JSON_DOCUMENT_BUF_SIZE)
+                : request(request), doc(capacity), root(doc.to<JsonObject>()) {}
+
+        JsonVariant &getRoot() { return root; }
+
+        /**
+         * @brief Serializes the document into a response in the format the client accepts
+         * @return The response, to add headers to and send
+         */
+        AsyncWebServerResponse *build() {
+            auto msgPack = acceptsMsgPack(request);
+            auto *response = request->beginResponseStream(msgPack ? MSGPACK_CONTENT_TYPE : "application/json");
+            if (msgPack) serializeMsgPack(doc, *response);
+            else serializeJson(doc, *response);
+            response->addHeader("Vary", "Accept");
+            return response;
+        }
+
+        /**
+         * @brief Serializes the document and sends it
+         */
+        void send() { request->send(build()); }
+
+        // delete copy constructor and assignment operator
+
+        DocumentResponse(const DocumentResponse &) = delete;
+
+        DocumentResponse &operator=(const DocumentResponse &) = delete;
+
+    };
+
+    /**
+     * @brief The body of a request of the web API, which is either JSON or MessagePack as told by its content type
+     */
+    class DocumentBody {
+
+    public:
+
+        /**
+         * @brief Collects the chunks of the body in the request's temporary object, which the request frees;
+         * bodies larger than the maximum size are dropped
+         */
+        static void collect(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+            collectUpTo(request, data, len, index, total, JSON_BODY_MAX_SIZE);
+        }
+
+        /**
+         * @brief Collects the chunks of the body in the request's temporary object, which the request frees
+         * unless it is taken over; bodies larger than the given size are dropped
+         */
+        static void collectUpTo(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total,
+                                size_t maxSize) {
+            if (total > maxSize) return;
+            if (index == 0) request->_tempObject = malloc(total);
+            if (request->_tempObject == nullptr) return;
+            memcpy((uint8_t *) request->_tempObject + index, data, len);
+        }
+
+        /**
+         * @brief Parses the collected body of the given request
+         * @param request The request
+         * @param doc The document to parse the body into
+         * @return true if the body was parsed, false if there is none or it is invalid
+         */
+        static bool parse(AsyncWebServerRequest *request, JsonDocument &doc) {
+            if (request->_tempObject == nullptr) return false;
+            auto *body = (const char *) request->_tempObject;
+            auto length = request->contentLength();
+            auto error = request->contentType().indexOf("msgpack") >= 0
+                         ? deserializeMsgPack(doc, body, length)
+                         : deserializeJson(doc, body, length);
+            return !error;
+        }
+
+    };
+
+}
+
+
+#endif //ALARM_CLOCK_API_DOCUMENT_HPP
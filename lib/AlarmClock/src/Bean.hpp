@@ -8,12 +8,19 @@
 // TODO: comment
 
 
+/**
+ * Incremented whenever the value of a tracked bean is set, so a change of the stored settings can be detected cheaply
+ */
+std::atomic<uint32_t> beanRevision{0};
+
+
 template<typename T>
 class Bean {
 
     T value{};
     const char *name;
     Preferences &preferences;
+    const bool tracked; // whether a change is counted in the bean revision; false for internal state
 
 protected:
 
@@ -25,17 +32,35 @@ protected:
 
 public:
 
-    Bean(const char *name, Preferences &preferences) : name(name), preferences(preferences) {}
+    Bean(const char *name, Preferences &preferences, bool tracked = true)
+            : name(name), preferences(preferences), tracked(tracked) {}
 
     T get() const { return value; }
 
-    void set(T val) { put(preferences, name, value = val); }
+    void set(T val) {
+        put(preferences, name, value = val);
+        if (tracked) ++beanRevision;
+    }
 
     void load() {
         if (preferences.isKey(name)) value = get(preferences, name);
         else put(preferences, name, value);
     }
 
+    /**
+     * Loads the value, taking it over from a legacy key if the value was not stored yet; the legacy key is removed
+     * @param legacyName The key the value was stored under before
+     * @param getLegacy The getter of the preferences the legacy value is read with
+     */
+    template<typename L>
+    void migrate(const char *legacyName, L (Preferences::*getLegacy)(const char *, L)) {
+        if (!preferences.isKey(name) && preferences.isKey(legacyName)) {
+            set((T) (preferences.*getLegacy)(legacyName, L{}));
+            preferences.remove(legacyName);
+        }
+        load();
+    }
+
     void reset() { preferences.remove(name); }
 
     explicit operator T() const { return get(); }
@@ -57,7 +82,7 @@ class Uint8Bean : public Bean<uint8_t> {
 
 public:
 
-    Uint8Bean(const char *name, Preferences &preferences) : Bean(name, preferences) {}
+    Uint8Bean(const char *name, Preferences &preferences, bool tracked = true) : Bean(name, preferences, tracked) {}
 
     Uint8Bean &operator=(uint8_t val) override {
         set(val);
@@ -66,6 +91,48 @@ public:
 
 };
 
+class Uint16Bean : public Bean<uint16_t> {
+
+    uint16_t get(Preferences &preferences, const char *name) const override {
+        return preferences.getUShort(name);
+    }
+
+    void put(Preferences &preferences, const char *name, uint16_t value) const override {
+        assert(preferences.putUShort(name, value));
+    }
+
+public:
+
+    Uint16Bean(const char *name, Preferences &preferences, bool tracked = true) : Bean(name, preferences, tracked) {}
+
+    Uint16Bean &operator=(uint16_t val) override {
+        set(val);
+        return *this;
+    }
+
+};
+
+class Uint32Bean : public Bean<uint32_t> {
+
+    uint32_t get(Preferences &preferences, const char *name) const override {
+        return preferences.getUInt(name);
+    }
+
+    void put(Preferences &preferences, const char *name, uint32_t value) const override {
+        assert(preferences.putUInt(name, value));
+    }
+
+public:
+
+    Uint32Bean(const char *name, Preferences &preferences, bool tracked = true) : Bean(name, preferences, tracked) {}
+
+    Uint32Bean &operator=(uint32_t val) override {
+        set(val);
+        return *this;
+    }
+
+};
+
 class BoolBean : public Bean<bool> {
 
     bool get(Preferences &preferences, const char *name) const override {
@@ -78,7 +145,7 @@ class BoolBean : public Bean<bool> {
 
 public:
 
-    BoolBean(const char *name, Preferences &preferences) : Bean(name, preferences) {}
+    BoolBean(const char *name, Preferences &preferences, bool tracked = true) : Bean(name, preferences, tracked) {}
 
     BoolBean &operator=(bool val) override {
         set(val);
@@ -99,7 +166,7 @@ class StringBean : public Bean<String> {
 
 public:
 
-    StringBean(const char *name, Preferences &preferences) : Bean(name, preferences) {}
+    StringBean(const char *name, Preferences &preferences, bool tracked = true) : Bean(name, preferences, tracked) {}
 
     StringBean &operator=(String val) override {
         set(val);
@@ -131,15 +131,6 @@ namespace AlarmClock {
             json["duration"] = getDuration();
         }
 
-        /**
-         * @brief Sets the duty to the given value and resets the timer if the duty is greater than 0
-         * @param duty The duty to set
-         */
-        void fromJson(JsonVariant &json) {
-            setDuty(json["duty"].as<uint8_t>());
-            setDuration(json["duration"].as<uint8_t>());
-        }
-
         // delete copy constructor and assignment operator
 
         MainLight(const MainLight &) = delete;
@@ -0,0 +1,30 @@
+#ifndef ALARM_CLOCK_MEMORY_STREAM_HPP
+#define ALARM_CLOCK_MEMORY_STREAM_HPP
+
+
+/**
+ * A read-only stream over a buffer in RAM, e.g. an uploaded body, so it can be parsed like a file\n
+ * The stream does not own the buffer. Reading past the end does not wait for more data.
+ */
+class MemoryStream : public Stream {
+
+    const uint8_t *data;
+    size_t length;
+    size_t position{0};
+
+public:
+
+    MemoryStream(const uint8_t *data, size_t length) : data(data), length(length) { setTimeout(0); }
+
+    int available() override { return (int) (length - position); }
+
+    int read() override { return position < length ? data[position++] : -1; }
+
+    int peek() override { return position < length ? data[position] : -1; }
+
+    size_t write(uint8_t) override { return 0; }
+
+};
+
+
+#endif //ALARM_CLOCK_MEMORY_STREAM_HPP
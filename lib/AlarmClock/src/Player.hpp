@@ -5,20 +5,141 @@
 #ifndef ALARM_CLOCK_PLAYER_H
 #define ALARM_CLOCK_PLAYER_H
 
-// TODO:
-//  maybe add file count reading to allow alarm having sounds
-//  when no sound names were stored on the internal storage
-
 
 namespace AlarmClock {
 
     /**
-     * @brief The player class that handles the DFPlayer Mini and contains the player's current volume
+     * @brief The player class that handles the DFPlayer Mini and contains the player's current volume\n
+     * All commands are queued and sent by the player driver's task, so none of the functions block on the serial line.
+     * After setup and whenever a card is inserted, the files on the player's SD card are counted in the background.
      */
     class Player {
 
-        DFRobotDFPlayerMini player{};
+    public:
+
+        static constexpr uint8_t MAX_FOLDERS = 99; // the DFPlayer Mini supports the folders 01 to 99
+
+        /**
+         * @brief The number of files on the player's SD card
+         */
+        struct Catalog {
+            uint16_t files{0}; // the number of all files, i.e. the tracks playable by their number
+            uint8_t folders{0}; // the number of folders, which need not be numbered consecutively
+            uint8_t lastFolder{0}; // the highest number of a folder with files
+            std::array<uint16_t, MAX_FOLDERS> folderFiles{}; // the number of files of each folder, starting at 01
+
+            Catalog() = default;
+        };
+
+    private:
+
+        /**
+         * The step of the discovery of the SD card's files; each step waits for the answer to its query
+         */
+        enum class Discovery {
+            Idle,
+            Files,
+            Folders,
+            FolderFiles
+        };
+
+        DFPlayerAsync player{};
         Uint8Bean volume;
+        DFPlayerAsync::EventCallback eventCallback{};
+        std::function<void()> catalogCallback{};
+        Catalog catalog{};
+        portMUX_TYPE catalogMux = portMUX_INITIALIZER_UNLOCKED;
+
+        // owned by the player driver's task
+        Discovery discovery{Discovery::Idle};
+        Catalog discovered{};
+        uint8_t folder{0};
+        uint8_t foundFolders{0}; // the number of folders with files that were found so far
+
+        /**
+         * @brief Starts to count the files on the SD card
+         */
+        void discover() {
+            discovery = Discovery::Files;
+            discovered = Catalog{};
+            if (!player.send(DFPlayerAsync::QUERY_FILES)) discovery = Discovery::Idle;
+        }
+
+        /**
+         * @brief Publishes the given catalog and notifies the catalog callback
+         * @param published The catalog to publish
+         */
+        void publish(const Catalog &published) {
+            portENTER_CRITICAL(&catalogMux);
+            catalog = published;
+            portEXIT_CRITICAL(&catalogMux);
+            if (catalogCallback) catalogCallback();
+        }
+
+        /**
+         * @brief Queries the file count of the next folder or publishes the catalog if all folders were counted\n
+         * The folders need not be numbered consecutively, so the folder numbers are probed
+         * until as many folders with files were found as the player reported.
+         */
+        void discoverNextFolder() {
+            if (foundFolders < discovered.folders && folder < MAX_FOLDERS) {
+                discovery = Discovery::FolderFiles;
+                if (player.send(DFPlayerAsync::QUERY_FOLDER_FILES, ++folder)) return;
+            }
+            discovery = Discovery::Idle;
+            publish(discovered);
+        }
+
+        void onResponse(uint8_t command, uint16_t value) {
+            switch (command) {
+                case DFPlayerAsync::QUERY_FILES:
+                    if (discovery != Discovery::Files) break;
+                    discovered.files = value;
+                    discovery = Discovery::Folders;
+                    if (!player.send(DFPlayerAsync::QUERY_FOLDERS)) discovery = Discovery::Idle;
+                    break;
+                case DFPlayerAsync::QUERY_FOLDERS:
+                    if (discovery != Discovery::Folders) break;
+                    discovered.folders = (uint8_t) min(value, (uint16_t) MAX_FOLDERS);
+                    folder = 0;
+                    foundFolders = 0;
+                    discoverNextFolder();
+                    break;
+                case DFPlayerAsync::QUERY_FOLDER_FILES:
+                    if (discovery != Discovery::FolderFiles) break;
+                    discovered.folderFiles[folder - 1] = value;
+                    if (value > 0) {
+                        foundFolders++;
+                        discovered.lastFolder = folder;
+                    }
+                    discoverNextFolder();
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        void onPlayerEvent(DFPlayerAsync::Event event, uint16_t param) {
+            switch (event) {
+                case DFPlayerAsync::Event::CardInserted:
+                    discover();
+                    break;
+                case DFPlayerAsync::Event::CardRemoved:
+                    discovery = Discovery::Idle;
+                    publish(Catalog{});
+                    break;
+                case DFPlayerAsync::Event::Error:
+                    // a folder in the numbering's gap does not exist, so it has no files
+                    if (discovery == Discovery::FolderFiles) discoverNextFolder();
+                    break;
+                case DFPlayerAsync::Event::CommandFailed:
+                    discovery = Discovery::Idle;
+                    break;
+                default:
+                    break;
+            }
+            if (eventCallback) eventCallback(event, param);
+        }
 
     public:
 
@@ -29,18 +150,49 @@ namespace AlarmClock {
          * @return true if setup was successful, false otherwise
          */
         bool setup() {
+            player.onEvent([this](DFPlayerAsync::Event event, uint16_t param) { onPlayerEvent(event, param); });
+            player.onResponse([this](uint8_t command, uint16_t value) { onResponse(command, value); });
             Serial2.begin(9600);
-            if (player.begin(Serial2, true, false)) {
-                player.setTimeOut(500);
-                player.EQ(DFPLAYER_EQ_NORMAL);
+            if (player.begin(Serial2)) {
+                player.EQ(DFPlayerAsync::EQ_NORMAL);
                 volume.load();
                 player.volume((uint8_t) volume);
-                player.outputDevice(DFPLAYER_DEVICE_SD);
+                player.outputDevice(DFPlayerAsync::DEVICE_SD);
+                discover();
                 return true;
             }
             return false;
         }
 
+        /**
+         * @brief Sets the callback the player's events, e.g. a finished track or a removed card, are reported to
+         * @param callback The callback; called from the player driver's task, so it must not block
+         */
+        void onEvent(const DFPlayerAsync::EventCallback &callback) { eventCallback = callback; }
+
+        /**
+         * @brief Sets the callback that is called when the files on the SD card were counted
+         * @param callback The callback; called from the player driver's task, so it must not block
+         */
+        void onCatalog(const std::function<void()> &callback) { catalogCallback = callback; }
+
+        /**
+         * @brief Returns the number of files on the SD card as counted last
+         * @return The catalog of the SD card; empty until the files were counted
+         */
+        Catalog getCatalog() {
+            portENTER_CRITICAL(&catalogMux);
+            auto copy = catalog;
+            portEXIT_CRITICAL(&catalogMux);
+            return copy;
+        }
+
+        /**
+         * @brief Checks whether a sound is playing
+         * @return true if a sound is playing, false otherwise
+         */
+        bool isPlaying() const { return player.isPlaying(); }
+
         /**
          * @brief Returns the current volume
          * @return The current volume
@@ -69,16 +221,34 @@ namespace AlarmClock {
         void decrVolume() { setVolume((getVolume() + 30) % 31); }
 
         /**
-         * @brief Plays the given sound
-         * @param sound The sound to play; if 0, sound 1 is played
+         * @brief Plays the given global track
+         * @param track The track to play; if 0, track 1 is played
          */
-        void play(uint8_t sound) { player.play(max(sound, (uint8_t) 1)); }
+        void play(uint16_t track) { player.play(max(track, (uint16_t) 1)); }
 
         /**
-         * @brief Plays the given sound in a loop
-         * @param sound The sound to play; if 0, sound 1 is played
+         * @brief Plays the given global track in a loop
+         * @param track The track to play; if 0, track 1 is played
          */
-        void playLoop(uint8_t sound) { player.loop(max(sound, (uint8_t) 1)); }
+        void playLoop(uint16_t track) { player.loop(max(track, (uint16_t) 1)); }
+
+        /**
+         * @brief Plays the given sound by its folder and track
+         * @param sound The sound to play
+         */
+        void play(const Sound &sound) {
+            if (sound.getFolder()) player.playFolder(sound.getFolder(), sound.getTrack());
+            else play(sound.getTrack());
+        }
+
+        /**
+         * @brief Plays the given sound by its folder and track in a loop
+         * @param sound The sound to play
+         */
+        void playLoop(const Sound &sound) {
+            if (sound.getFolder()) player.loopFolder(sound.getFolder(), sound.getTrack());
+            else playLoop(sound.getTrack());
+        }
 
         /**
          * @brief Stops the player playback
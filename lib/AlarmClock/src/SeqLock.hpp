@@ -0,0 +1,82 @@
+#ifndef ALARM_CLOCK_SEQ_LOCK_HPP
+#define ALARM_CLOCK_SEQ_LOCK_HPP
+
+
+/**
+ * A value shared between tasks, giving readers a consistent snapshot without ever blocking the writer\n
+ * The value is stored word-wise in atomics, guarded by a sequence counter that is odd while a write is in progress;
+ * readers retry until they copied the value without a write in between. Only a single task may write the value.
+ * @tparam T the type of the value; must be plain data that can be copied byte-wise
+ */
+template<typename T>
+class SeqLock {
+
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    std::atomic<uint32_t> sequence{0};
+    std::array<std::atomic<uint32_t>, WORDS> words{};
+
+public:
+
+    /**
+     * Initializes the value to a default constructed T\n
+     * The words are written directly, as the value is not shared yet and
+     * the scheduler must not be suspended during static initialization.
+     */
+    SeqLock() {
+        std::array<uint32_t, WORDS> buffer{};
+        T value{};
+        memcpy(buffer.data(), &value, sizeof(T));
+        for (size_t i = 0; i < WORDS; ++i) words[i].store(buffer[i], std::memory_order_relaxed);
+    }
+
+    /**
+     * Stores a new value\n
+     * The scheduler of the writing core is suspended during the write,
+     * so a reader of higher priority cannot spin on a write that was preempted.
+     * @param value the new value
+     */
+    void store(const T &value) {
+        std::array<uint32_t, WORDS> buffer{};
+        memcpy(buffer.data(), &value, sizeof(T));
+        vTaskSuspendAll();
+        auto seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; ++i) words[i].store(buffer[i], std::memory_order_relaxed);
+        sequence.store(seq + 2, std::memory_order_release);
+        xTaskResumeAll();
+    }
+
+    /**
+     * Loads a consistent snapshot of the value
+     * @return the value
+     */
+    T load() const {
+        std::array<uint32_t, WORDS> buffer{};
+        uint32_t seq;
+        do {
+            while ((seq = sequence.load(std::memory_order_acquire)) & 1);
+            for (size_t i = 0; i < WORDS; ++i) buffer[i] = words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+        } while (sequence.load(std::memory_order_relaxed) != seq);
+        T value;
+        memcpy((void *) &value, buffer.data(), sizeof(T));
+        return value;
+    }
+
+    SeqLock &operator=(const T &value) {
+        store(value);
+        return *this;
+    }
+
+    // delete copy constructor and assignment operator
+
+    SeqLock(const SeqLock &) = delete;
+
+    SeqLock &operator=(const SeqLock &) = delete;
+
+};
+
+
+#endif //ALARM_CLOCK_SEQ_LOCK_HPP
@@ -0,0 +1,139 @@
+#ifndef ALARM_CLOCK_SHUFFLE_BAG_HPP
+#define ALARM_CLOCK_SHUFFLE_BAG_HPP
+
+
+namespace AlarmClock {
+
+    /**
+     * @brief Draws the sounds that are allowed to be played randomly in a random order without repeats\n
+     * The ids from 1 to the highest id are walked in the order of a linear congruential generator modulo the next
+     * power of two, which visits each id once per round without a buffer of the ids; ids without a sound that may be
+     * played randomly are skipped. Each round is started with a new seed. Only the seed, the position and the id
+     * drawn last are stored in the preferences, so the order is continued after a reboot. They are stored by store(),
+     * not when a sound is drawn.
+     */
+    class ShuffleBag {
+
+    public:
+
+        /**
+         * The position in the random order, as stored in the preferences
+         */
+        struct Position {
+            uint32_t seed;
+            uint16_t cursor; // the next value of the generator
+            uint16_t last; // the id drawn last, which is not drawn again right away
+        };
+
+    private:
+
+        Position position{0, 0, 0};
+        bool changed{false}; // whether the position changed since it was taken to be stored
+        Uint32Bean seed;
+        Uint16Bean cursor;
+        Uint16Bean last;
+        // the beans are internal state, so drawing a sound does not change the version of the settings
+
+        static uint32_t modulus(uint16_t maxId) {
+            uint32_t m = 1;
+            while (m < maxId) m <<= 1;
+            return m;
+        }
+
+        uint16_t start(uint32_t m) const { return (uint16_t) ((position.seed >> 8) & (m - 1)); }
+
+        /**
+         * @brief Advances the generator; its multiplier is 1 modulo 4 and its increment is odd, so it has full period
+         */
+        uint16_t step(uint16_t value, uint32_t m) const {
+            auto multiplier = (position.seed & ~3u) | 1;
+            auto increment = (position.seed >> 16) | 1;
+            return (uint16_t) ((multiplier * value + increment) & (m - 1));
+        }
+
+        /**
+         * @brief Starts a new round with a new seed
+         */
+        void renew(uint32_t m) {
+            position.seed = esp_random() | 1; // a seed of 0 marks that no round was started yet
+            position.cursor = start(m);
+        }
+
+    public:
+
+        explicit ShuffleBag(Preferences &preferences)
+                : seed("SndSeed", preferences, false), cursor("SndCursor", preferences, false),
+                  last("SndPrev", preferences, false) {}
+
+        /**
+         * @brief Loads the position in the random order from the preferences
+         */
+        void load() {
+            seed.load();
+            cursor.load();
+            last.load();
+            position = {(uint32_t) seed, (uint16_t) cursor, (uint16_t) last};
+        }
+
+        /**
+         * @brief Draws the next id that may be played randomly; allocates no memory and does not write the preferences
+         * @param maxId The highest id of the sounds
+         * @param eligible Tells whether the sound with the given id exists and may be played randomly
+         * @return The id or 0 if no sound may be played randomly
+         */
+        template<typename F>
+        uint16_t next(uint16_t maxId, F eligible) {
+            if (maxId == 0) return 0;
+            auto m = modulus(maxId);
+            if (position.seed == 0 || position.cursor >= m) renew(m);
+            changed = true;
+            bool skipped = false;
+            // the rest of the current round and a whole new one hold every id
+            for (uint32_t i = 0; i < 2 * m; ++i) {
+                auto id = (uint32_t) position.cursor + 1;
+                position.cursor = step(position.cursor, m);
+                if (position.cursor == start(m)) renew(m);
+                if (id > maxId || !eligible((uint16_t) id)) continue;
+                if (id == position.last) {
+                    skipped = true;
+                    continue;
+                }
+                position.last = (uint16_t) id;
+                return position.last;
+            }
+            return skipped ? position.last : 0;
+        }
+
+        bool isChanged() const { return changed; }
+
+        /**
+         * @brief Takes the position to store it
+         * @return The current position
+         */
+        Position take() {
+            changed = false;
+            return position;
+        }
+
+        /**
+         * @brief Writes a position to the preferences; must not be called concurrently with itself or load()
+         * @param stored The position
+         */
+        void store(const Position &stored) {
+            seed = stored.seed;
+            cursor = stored.cursor;
+            last = stored.last;
+        }
+
+        // delete copy constructor and assignment operator
+
+        ShuffleBag(const ShuffleBag &) = delete;
+
+        ShuffleBag &operator=(const ShuffleBag &) = delete;
+
+    };
+
+}
+
+
+#endif //ALARM_CLOCK_SHUFFLE_BAG_HPP
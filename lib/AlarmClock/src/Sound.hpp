@@ -9,149 +9,55 @@
 namespace AlarmClock {
 
     /**
-     * @brief Class that represents a sound
+     * @brief Class that represents a sound\n
+     * A sound is either addressed by its global track number on the player's SD card
+     * or by its track in one of the numbered folders.
+     * The sound is stored as is as a record of the sound catalog's file, its name is read from the file when needed.
      */
     class Sound {
 
-        uint8_t id;
-        String name;
-        bool allowRandom;
-        bool played{false};
+        friend class SoundCatalog;
 
-    public:
-
-        Sound(uint8_t id, String name, bool allowRandom) : id(id), name(std::move(name)), allowRandom(allowRandom) {}
-
-        uint8_t getId() const { return id; }
+        static constexpr uint8_t ALLOW_RANDOM = BIT0;
+        static constexpr uint8_t IN_JOURNAL = BIT2; // the name is stored in the catalog's journal
+        static constexpr uint8_t NO_FILE = BIT3; // there is no file for the sound on the player's SD card
 
-        String getName() const { return name; }
+        uint16_t id;
+        uint16_t track;
+        uint8_t folder; // 0 if the sound is addressed by its global track number
+        uint8_t flags;
+        uint8_t nameLength{0}; // 0 if the sound has its default name
+        uint8_t reserved{0};
+        uint32_t nameOffset{0}; // the position of the name in the sound catalog's file or journal
 
-        bool isAllowRandom() const { return allowRandom; }
-
-        void setAllowRandom(bool value) { allowRandom = value; }
+    public:
 
-        /**
-         * @brief Creates JSON data from the sound
-         * @param json The JSON object to create the JSON data in
-         */
-        void toJson(JsonVariant &json) const {
-            json["id"] = id;
-            json["name"] = name;
-            json["allowRandom"] = allowRandom;
-        }
+        Sound() : Sound(0, false) {}
 
-        /**
-         * @brief Creates a sound from the given JSON data
-         * @param json The JSON data to create the sound from
-         * @return The sound created from the given JSON data
-         */
-        static Sound fromJson(JsonVariant &json) {
-            return {json["id"], json["name"], json["allowRandom"]};
-        }
+        Sound(uint16_t id, bool allowRandom, uint8_t folder = 0, uint16_t track = 0)
+                : id(id), track(track != 0 ? track : id), folder(folder),
+                  flags(allowRandom ? ALLOW_RANDOM : 0) {}
 
-        /**
-         * @brief Creates JSON data from the given sounds
-         * @param sounds The sounds to create JSON data from
-         * @param json The JSON object to create the JSON data in
-         */
-        static void soundsToJson(std::vector<Sound> &sounds, JsonVariant &json) {
-            for (auto &sound: sounds) {
-                JsonVariant soundJson = json.createNestedObject();
-                soundJson["id"] = sound.id;
-                soundJson["name"] = sound.name;
-                soundJson["allowRandom"] = sound.allowRandom;
-            }
-        }
+        uint16_t getId() const { return id; }
 
-        /**
-         * @brief Creates a vector of sounds from the given JSON data
-         * @param json The JSON data to create the sounds from
-         * @return The sounds created from the given JSON data
-         */
-        static std::vector<Sound> soundsFromJson(JsonVariant &json) {
-            std::vector<Sound> sounds;
-            auto array = json.as<JsonArray>();
-            for (auto soundJson: array) {
-                sounds.emplace_back(soundJson["id"], soundJson["name"], soundJson["allowRandom"]);
-            }
-            return sounds;
-        }
+        bool isAllowRandom() const { return flags & ALLOW_RANDOM; }
 
         /**
-         * @brief Loads the sounds from the given file on the SPIFFS filesystem as JSON data
-         * @param fileName The name of the file to load the sounds from
-         * @return The sounds loaded from the given file
+         * @brief Checks whether the sound's file was on the player's SD card when its files were counted last
+         * @return true if the sound has a file, false otherwise
          */
-        static std::vector<Sound> loadSounds(const char *fileName) {
-            auto file = SPIFFS.open(fileName);
-            if (!file) return {};
-            DynamicJsonDocument doc(JSON_SOUNDS_BUF_SIZE);
-            auto error = deserializeJson(doc, file);
-            assert(!error && "Failed to parse sounds file");
-            file.close();
-            JsonVariant json = doc.as<JsonVariant>();
-            return soundsFromJson(json);
-        }
+        bool hasFile() const { return !(flags & NO_FILE); }
 
-        /**
-         * @brief Saves the given sounds as JSON data to the given file on the SPIFFS filesystem
-         * @param fileName The name of the file to save the sounds to
-         * @param sounds The sounds to save
-         */
-        static void saveSounds(const char *fileName, std::vector<Sound> &sounds) {
-            auto file = SPIFFS.open(fileName, FILE_WRITE);
-            assert(file && "Failed to open sounds file");
-            JsonVariant json = DynamicJsonDocument(JSON_SOUNDS_BUF_SIZE);
-            soundsToJson(sounds, json);
-            auto error = serializeJson(json, file);
-            assert(!error && "Failed to serialize sounds file");
-            file.close();
-        }
+        uint8_t getFolder() const { return folder; }
 
-        /**
-         * @brief Returns an iterator to the sound with the given id
-         * @param id The id of the sound to search for
-         * @param sounds The sounds to search in
-         * @return An iterator to the sound with the given id
-         */
-        static __gnu_cxx::__normal_iterator<Sound *, std::vector<Sound>>
-        getSoundById(uint8_t id, std::vector<Sound> &sounds) {
-            auto sound = std::find_if(
-                    sounds.begin(),
-                    sounds.end(),
-                    [id](const Sound &s) { return s.getId() == id; }
-            );
-            return sound;
-        }
+        uint16_t getTrack() const { return track; }
 
         /**
-         * @brief Finds a random sound that is allowed to be played randomly and has not been played yet\n
-         * If no such sound exists, all sounds that are allowed to be played randomly are reset and a random sound is
-         * returned. The sound that is returned is marked as played.
-         * @param sounds The sounds to search in
-         * @return A random sound that is allowed to be played randomly and has not been played yet
+         * @brief Returns the name of a sound that was not named
+         * @return The default name, containing the folder and track if the sound is addressed by them
          */
-        static const Sound &findRandomSound(std::vector<Sound> &sounds) {
-            std::vector<int> validIndices;
-            for (int i = 0; i < sounds.size(); ++i) {
-                if (sounds[i].allowRandom && !sounds[i].played) {
-                    validIndices.push_back(i);
-                }
-            }
-
-            if (validIndices.empty()) {
-                for (int i = 0; i < sounds.size(); ++i) {
-                    if (sounds[i].allowRandom) {
-                        sounds[i].played = false;
-                        validIndices.push_back(i);
-                    }
-                }
-            }
-
-            auto randomIndex = random((long) validIndices.size());
-            auto selectedSoundIndex = validIndices[randomIndex];
-            sounds[selectedSoundIndex].played = true;
-            return sounds[selectedSoundIndex];
+        String getDefaultName() const {
+            return folder ? "Sound " + String(folder) + "/" + String(track) : "Sound " + String(id);
         }
 
     };
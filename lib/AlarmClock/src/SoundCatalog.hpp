@@ -0,0 +1,981 @@
+#ifndef ALARM_CLOCK_SOUND_CATALOG_HPP
+#define ALARM_CLOCK_SOUND_CATALOG_HPP
+
+
+namespace AlarmClock {
+
+    /**
+     * @brief The sounds that can be played, sorted by their id\n
+     * The sounds are stored in a binary file on the SPIFFS filesystem: a header, the sounds as fixed-size records
+     * and a string table holding the sounds' names. All records are read with a single read and kept in RAM,
+     * the names stay in the file and are only read when needed. A dense table maps each id to the sound's index,
+     * so a sound is found without searching. JSON is only used to import and export the sounds.\n
+     * Changes of single sounds are appended to a journal as small entries, which are applied on top of the catalog
+     * file when it is loaded. Once the journal is full, a low priority task compacts it into a new catalog file.\n
+     * The compaction moves the names, so all accesses hold the catalog's mutex and sounds are only handed out as copies;
+     * names are read by the sound's id.
+     */
+    class SoundCatalog {
+
+        struct Header {
+            uint32_t magic;
+            uint16_t version;
+            uint16_t count; // the number of records
+            uint32_t stringsOffset; // the position of the string table, directly after the records
+        };
+
+        /**
+         * The operations of the journal's entries; each entry is the operation, padding and the changed sound's record
+         */
+        enum Operation : uint8_t {
+            PUT = 1, // adds or replaces the sound, keeping the name the record refers to
+            PUT_NAMED = 2, // adds or replaces the sound; its new name follows the entry
+            REMOVE = 3 // removes the sound with the record's id
+        };
+
+        static constexpr uint32_t MAGIC = 0x43534341; // "ACSC"
+        static constexpr uint16_t VERSION = 1;
+        static constexpr size_t ENTRY_SIZE = 4 + sizeof(Sound);
+
+        static_assert(sizeof(Sound) == 12, "The sound is stored as record of the catalog file");
+
+        std::vector<Sound> sounds{};
+        std::vector<uint16_t> index{}; // the index of the sound with the id plus 1, or 0 if there is no such sound
+        ShuffleBag bag;
+        volatile uint32_t revision{0}; // incremented on every change of the sounds
+        const SemaphoreHandle_t mutex;
+        const SemaphoreHandle_t fileMutex; // serializes the writes of the catalog file; taken before the mutex
+        TaskHandle_t compactTask{nullptr};
+
+        /**
+         * Guard holding the catalog's mutex for its lifetime
+         */
+        class Lock {
+
+            const SemaphoreHandle_t mutex;
+
+        public:
+
+            explicit Lock(SemaphoreHandle_t mutex) : mutex(mutex) { xSemaphoreTakeRecursive(mutex, portMAX_DELAY); }
+
+            ~Lock() { xSemaphoreGiveRecursive(mutex); }
+
+            // delete copy constructor and assignment operator
+
+            Lock(const Lock &) = delete;
+
+            Lock &operator=(const Lock &) = delete;
+
+        };
+
+        static size_t recordPosition(size_t i) { return sizeof(Header) + i * sizeof(Sound); }
+
+        /**
+         * @brief Reads and validates the header of a catalog file
+         * @param file The catalog file, positioned at its start
+         * @param header The header to read into
+         * @return true if the header is valid, false otherwise
+         */
+        static bool readHeader(File &file, Header &header) {
+            return file.read((uint8_t *) &header, sizeof(Header)) == sizeof(Header)
+                   && header.magic == MAGIC && header.version == VERSION
+                   && header.stringsOffset == recordPosition(header.count)
+                   && file.size() >= header.stringsOffset;
+        }
+
+        /**
+         * @brief Checks whether a catalog file was written completely, i.e. it ends after the last name
+         * @param file The catalog file, positioned at its start
+         * @return true if the file is complete, false otherwise
+         */
+        static bool isComplete(File &file) {
+            Header header{};
+            if (!readHeader(file, header)) return false;
+            size_t end = header.stringsOffset;
+            Sound sound{};
+            for (uint16_t i = 0; i < header.count; ++i) {
+                if (file.read((uint8_t *) &sound, sizeof(Sound)) != sizeof(Sound)) return false;
+                end += sound.nameLength;
+            }
+            return file.size() == end;
+        }
+
+        static void setFlag(Sound &sound, uint8_t flag, bool value) {
+            sound.flags = (uint8_t) (value ? sound.flags | flag : sound.flags & ~flag);
+        }
+
+        /**
+         * @brief Reads the name of a sound from the given catalog file or journal, whichever holds it
+         * @param file The catalog file
+         * @param journal The journal
+         * @param sound The sound
+         * @return The name or the sound's default name if it has none
+         */
+        static String readName(File &file, File &journal, const Sound &sound) {
+            auto &in = sound.flags & Sound::IN_JOURNAL ? journal : file;
+            std::array<char, UINT8_MAX + 1> buffer{};
+            if (sound.nameLength == 0 || !in || !in.seek(sound.nameOffset)) return sound.getDefaultName();
+            auto read = in.read((uint8_t *) buffer.data(), sound.nameLength);
+            buffer[read] = '\0';
+            return buffer.data();
+        }
+
+        /**
+         * @brief Returns the length the given name is stored with
+         * @param sound The sound to name
+         * @param name The name
+         * @return The length; 0 for an empty or the default name, at most 255
+         */
+        static uint8_t nameLength(const Sound &sound, const String &name) {
+            if (name.length() == 0 || name == sound.getDefaultName()) return 0;
+            return (uint8_t) min(name.length(), (unsigned int) UINT8_MAX);
+        }
+
+        /**
+         * @brief Returns the sound with the given id; the mutex must be held while the sound is used
+         * @param id The id of the sound
+         * @return The sound or nullptr if there is no sound with the given id
+         */
+        const Sound *locate(uint16_t id) const {
+            return id < index.size() && index[id] ? &sounds[index[id] - 1] : nullptr;
+        }
+
+        /**
+         * @brief Reads the name of the given sound from the catalog file or the journal; the mutex must be held
+         * @param sound The sound
+         * @return The name of the sound
+         */
+        static String readName(const Sound &sound) {
+            if (sound.nameLength == 0) return sound.getDefaultName();
+            auto file = SPIFFS.open(SOUNDS_FILE_NAME);
+            auto journal = SPIFFS.open(SOUNDS_JOURNAL_FILE_NAME);
+            auto name = readName(file, journal, sound);
+            if (file) file.close();
+            if (journal) journal.close();
+            return name;
+        }
+
+        /**
+         * @brief Skips the whitespace in a JSON stream
+         * @param stream The stream
+         * @return The next character, which is not consumed, or -1 at the end of the stream
+         */
+        static int peekToken(Stream &stream) {
+            int c;
+            while ((c = stream.peek()) == ' ' || c == '\n' || c == '\r' || c == '\t') stream.read();
+            return c;
+        }
+
+        /**
+         * @brief Reads the header of a MessagePack array
+         * @param stream The stream
+         * @param size Set to the number of elements of the array
+         * @return true if the stream starts with an array, false otherwise
+         */
+        static bool readMsgPackArray(Stream &stream, uint32_t &size) {
+            auto type = stream.read();
+            size_t lengthBytes;
+            if ((type & 0xF0) == 0x90) {
+                size = (uint32_t) (type & 0x0F);
+                return true;
+            } else if (type == 0xDC) lengthBytes = 2;
+            else if (type == 0xDD) lengthBytes = 4;
+            else return false;
+            size = 0;
+            for (size_t i = 0; i < lengthBytes; ++i) {
+                auto c = stream.read();
+                if (c < 0) return false;
+                size = size << 8 | (uint32_t) c;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Replaces all sounds by the sounds of the given array, parsing one sound at a time;
+         * the names are collected in a separate file until the catalog file is written\n
+         * Unknown keys of the sounds are skipped. If the array is malformed, e.g. a name is longer than 255 characters,
+         * nothing is imported and the current sounds are kept.
+         * @param stream The stream to read the array from
+         * @param msgPack true if the array is MessagePack, false if it is JSON
+         * @return true if the array was imported, false if it is malformed
+         */
+        bool import(Stream &stream, bool msgPack) {
+            Lock fileLock{fileMutex};
+            Lock lock{mutex};
+            auto names = SPIFFS.open(SOUNDS_NAMES_FILE_NAME, FILE_WRITE);
+            assert(names && "Failed to open sound names file");
+            std::vector<Sound> imported;
+            StaticJsonDocument<JSON_OBJECT_SIZE(5)> filter;
+            filter["id"] = true;
+            filter["name"] = true;
+            filter["allowRandom"] = true;
+            filter["folder"] = true;
+            filter["track"] = true;
+            StaticJsonDocument<JSON_SOUND_BUF_SIZE> doc;
+            uint32_t remaining{0}; // the sounds left in a MessagePack array
+            bool valid;
+            bool more;
+            if (msgPack) {
+                valid = readMsgPackArray(stream, remaining);
+                more = valid && remaining != 0;
+            } else {
+                valid = peekToken(stream) == '[';
+                if (valid) stream.read();
+                more = valid && peekToken(stream) != ']';
+                if (valid && !more) stream.read();
+            }
+            while (more) {
+                auto error = msgPack ? deserializeMsgPack(doc, stream, DeserializationOption::Filter(filter))
+                                     : deserializeJson(doc, stream, DeserializationOption::Filter(filter));
+                if (error || !doc.is<JsonObject>()) {
+                    valid = false;
+                    break;
+                }
+                Sound sound{
+                        doc["id"].as<uint16_t>(),
+                        doc["allowRandom"].as<bool>(),
+                        doc["folder"] | (uint8_t) 0,
+                        doc["track"] | (uint16_t) 0
+                };
+                auto name = doc["name"].as<String>();
+                if (name.length() > UINT8_MAX) {
+                    valid = false;
+                    break;
+                }
+                sound.nameLength = nameLength(sound, name);
+                sound.nameOffset = (uint32_t) names.size();
+                names.write((const uint8_t *) name.c_str(), sound.nameLength);
+                imported.push_back(sound);
+                if (msgPack) more = --remaining != 0;
+                else {
+                    auto next = peekToken(stream);
+                    stream.read();
+                    more = next == ',';
+                    valid = more || next == ']';
+                }
+            }
+            names.close();
+            if (!valid) {
+                SPIFFS.remove(SOUNDS_NAMES_FILE_NAME);
+                return false;
+            }
+            sounds = std::move(imported);
+            reindex();
+            write(SOUNDS_NAMES_FILE_NAME);
+            SPIFFS.remove(SOUNDS_NAMES_FILE_NAME);
+            return true;
+        }
+
+        /**
+         * @brief Sorts the sounds by their id, drops sounds with an invalid or duplicate id and rebuilds the index
+         */
+        void reindex() {
+            std::stable_sort(sounds.begin(), sounds.end(), [](const Sound &a, const Sound &b) { return a.id < b.id; });
+            sounds.erase(
+                    std::unique(sounds.begin(), sounds.end(), [](const Sound &a, const Sound &b) {
+                        return a.id == b.id;
+                    }),
+                    sounds.end()
+            );
+            if (!sounds.empty() && sounds.front().id == 0) sounds.erase(sounds.begin());
+            index.assign(sounds.empty() ? 0 : sounds.back().id + 1, 0);
+            for (size_t i = 0; i < sounds.size(); ++i) index[sounds[i].id] = (uint16_t) (i + 1);
+            changed();
+        }
+
+        /**
+         * @brief Marks the sounds as changed
+         */
+        void changed() {
+            revision = revision + 1;
+        }
+
+        /**
+         * @brief Writes the given sounds to the temporary catalog file, packing their names into its string table;
+         * afterwards the sounds refer to their names in that file\n
+         * Only reads the other files, so a copy of the sounds can be written without holding the mutex.
+         * @param written The sounds, sorted by their id
+         * @param namesFileName The file the names of the sounds not changed by the journal are currently stored in
+         */
+        static void writeTmp(std::vector<Sound> &written, const char *namesFileName) {
+            auto out = SPIFFS.open(SOUNDS_TMP_FILE_NAME, FILE_WRITE);
+            assert(out && "Failed to open sounds file");
+            Header header{MAGIC, VERSION, (uint16_t) written.size(), (uint32_t) recordPosition(written.size())};
+            out.write((const uint8_t *) &header, sizeof(Header));
+            auto offset = header.stringsOffset;
+            for (auto sound: written) {
+                sound.flags &= (uint8_t) ~Sound::IN_JOURNAL;
+                sound.nameOffset = sound.nameLength ? offset : 0;
+                offset += sound.nameLength;
+                out.write((const uint8_t *) &sound, sizeof(Sound));
+            }
+            auto in = SPIFFS.open(namesFileName);
+            auto journal = SPIFFS.open(SOUNDS_JOURNAL_FILE_NAME);
+            std::array<uint8_t, UINT8_MAX> buffer{};
+            for (auto &sound: written) {
+                if (sound.nameLength == 0) continue;
+                auto &from = sound.flags & Sound::IN_JOURNAL ? journal : in;
+                // a name that cannot be read is padded, so the following names keep their offsets
+                buffer.fill(' ');
+                if (from && from.seek(sound.nameOffset)) from.read(buffer.data(), sound.nameLength);
+                out.write(buffer.data(), sound.nameLength);
+            }
+            if (in) in.close();
+            if (journal) journal.close();
+            out.close();
+            offset = header.stringsOffset;
+            for (auto &sound: written) {
+                sound.flags &= (uint8_t) ~Sound::IN_JOURNAL;
+                sound.nameOffset = sound.nameLength ? offset : 0;
+                offset += sound.nameLength;
+            }
+        }
+
+        /**
+         * @brief Replaces the catalog file and the journal by the complete temporary catalog file\n
+         * If a reset interrupts the replacement, the new file is moved into place by recover().
+         */
+        static void replaceFile() {
+            SPIFFS.remove(SOUNDS_JOURNAL_FILE_NAME);
+            SPIFFS.remove(SOUNDS_FILE_NAME);
+            SPIFFS.rename(SOUNDS_TMP_FILE_NAME, SOUNDS_FILE_NAME);
+        }
+
+        /**
+         * @brief Writes all sounds to a new catalog file, packing their names into its string table\n
+         * The file is written next to the current one and replaces it once it is complete.
+         * The journal is not needed afterwards and removed.
+         * @param namesFileName The file the names of the sounds not changed by the journal are currently stored in
+         */
+        void write(const char *namesFileName) {
+            writeTmp(sounds, namesFileName);
+            replaceFile();
+        }
+
+        /**
+         * @brief Makes a sound that refers to its name in the compacted catalog file or journal refer to it
+         * in the new catalog file or the rest of the journal
+         * @param sound The sound
+         * @param compacted The size of the journal the new catalog file holds the changes of
+         * @param written The sounds written to the new catalog file
+         */
+        static void rebase(Sound &sound, size_t compacted, const std::vector<Sound> &written) {
+            if (sound.nameLength == 0) return;
+            if (sound.flags & Sound::IN_JOURNAL && sound.nameOffset >= compacted) {
+                sound.nameOffset -= (uint32_t) compacted;
+                return;
+            }
+            // the name did not change since the sounds were copied, so the sound was written with it
+            auto found = std::lower_bound(written.begin(), written.end(), sound.id, [](const Sound &a, uint16_t id) {
+                return a.id < id;
+            });
+            bool exists = found != written.end() && found->id == sound.id;
+            sound.flags &= (uint8_t) ~Sound::IN_JOURNAL;
+            sound.nameOffset = exists ? found->nameOffset : 0;
+            sound.nameLength = exists ? found->nameLength : 0;
+        }
+
+        /**
+         * @brief Writes the journal's changes into the catalog file without holding the mutex during the write\n
+         * The sounds are copied and written to a new file, which then replaces the catalog file. The changes
+         * journaled in the meantime are kept in a new journal, their names moved along.
+         */
+        void compact() {
+            Lock fileLock{fileMutex};
+            std::vector<Sound> written;
+            size_t compacted;
+            {
+                Lock lock{mutex};
+                auto journal = SPIFFS.open(SOUNDS_JOURNAL_FILE_NAME);
+                compacted = journal ? journal.size() : 0;
+                if (journal) journal.close();
+                if (compacted == 0) return;
+                written = sounds;
+            }
+            writeTmp(written, SOUNDS_FILE_NAME);
+
+            Lock lock{mutex};
+            std::vector<uint8_t> rest;
+            auto journal = SPIFFS.open(SOUNDS_JOURNAL_FILE_NAME);
+            if (journal && journal.seek((uint32_t) compacted)) {
+                rest.resize(journal.size() - compacted);
+                rest.resize(journal.read(rest.data(), rest.size()));
+            }
+            if (journal) journal.close();
+            // entries that keep the name of their sound refer to it in the old files
+            for (size_t position = 0; position + ENTRY_SIZE <= rest.size();) {
+                Sound sound{};
+                memcpy((void *) &sound, rest.data() + position + 4, sizeof(Sound));
+                auto named = rest[position] == PUT_NAMED;
+                if (!named) {
+                    rebase(sound, compacted, written);
+                    memcpy(rest.data() + position + 4, (const void *) &sound, sizeof(Sound));
+                }
+                position += ENTRY_SIZE + (named ? sound.nameLength : 0);
+            }
+            replaceFile();
+            if (!rest.empty()) {
+                journal = SPIFFS.open(SOUNDS_JOURNAL_FILE_NAME, FILE_WRITE);
+                assert(journal && "Failed to open sounds journal");
+                journal.write(rest.data(), rest.size());
+                journal.close();
+            }
+            for (auto &sound: sounds) rebase(sound, compacted, written);
+        }
+
+        /**
+         * @brief Completes a write of the catalog file that was interrupted by a reset\n
+         * A complete new catalog file holds all changes of the journal, so it replaces both the catalog file
+         * and the journal, even if the catalog file was already removed; an incomplete one is dropped.
+         */
+        static void recover() {
+            if (!SPIFFS.exists(SOUNDS_TMP_FILE_NAME)) return;
+            auto file = SPIFFS.open(SOUNDS_TMP_FILE_NAME);
+            bool complete = file && isComplete(file);
+            if (file) file.close();
+            if (complete) {
+                SPIFFS.remove(SOUNDS_JOURNAL_FILE_NAME);
+                SPIFFS.remove(SOUNDS_FILE_NAME);
+                SPIFFS.rename(SOUNDS_TMP_FILE_NAME, SOUNDS_FILE_NAME);
+            } else {
+                SPIFFS.remove(SOUNDS_TMP_FILE_NAME);
+            }
+        }
+
+        /**
+         * @brief Appends a change to the journal with a single write; wakes up the compaction if the journal is full
+         * @param operation The operation
+         * @param sound The changed sound; its name is updated to refer to the journal if a name is given
+         * @param name The new name of the sound or nullptr if its name did not change
+         */
+        void journal(Operation operation, Sound &sound, const String *name = nullptr) {
+            auto file = SPIFFS.open(SOUNDS_JOURNAL_FILE_NAME, FILE_APPEND);
+            assert(file && "Failed to open sounds journal");
+            std::array<uint8_t, ENTRY_SIZE + UINT8_MAX> entry{};
+            size_t length = ENTRY_SIZE;
+            if (name) {
+                sound.nameLength = nameLength(sound, *name);
+                setFlag(sound, Sound::IN_JOURNAL, sound.nameLength != 0);
+                if (sound.nameLength) {
+                    operation = PUT_NAMED;
+                    sound.nameOffset = (uint32_t) (file.size() + ENTRY_SIZE);
+                    memcpy(entry.data() + ENTRY_SIZE, name->c_str(), sound.nameLength);
+                    length += sound.nameLength;
+                } else sound.nameOffset = 0;
+            }
+            entry[0] = operation;
+            memcpy(entry.data() + 4, (const void *) &sound, sizeof(Sound));
+            file.write(entry.data(), length);
+            auto size = file.size();
+            file.close();
+            if (size >= SOUNDS_JOURNAL_COMPACT_SIZE && compactTask != nullptr) xTaskNotifyGive(compactTask);
+        }
+
+        /**
+         * @brief Applies the changes of the journal to the sounds loaded from the catalog file
+         * @return The size of the journal
+         */
+        size_t replay() {
+            auto file = SPIFFS.open(SOUNDS_JOURNAL_FILE_NAME);
+            if (!file) return 0;
+            std::array<uint8_t, ENTRY_SIZE> entry{};
+            size_t position = 0;
+            // an entry cut off by a reset ends the journal
+            while (file.read(entry.data(), ENTRY_SIZE) == ENTRY_SIZE) {
+                Sound sound{};
+                memcpy((void *) &sound, entry.data() + 4, sizeof(Sound));
+                position += ENTRY_SIZE;
+                if (entry[0] == PUT_NAMED) {
+                    if (position + sound.nameLength > file.size()) break;
+                    sound.nameOffset = (uint32_t) position;
+                    position += sound.nameLength;
+                    file.seek(position);
+                }
+                if (sound.id == 0) continue;
+                auto i = sound.id < index.size() ? index[sound.id] : 0;
+                if (entry[0] == REMOVE) {
+                    // the removed sound is dropped with the next reindex
+                    if (i) sounds[i - 1].id = 0;
+                    if (i) index[sound.id] = 0;
+                } else if (i) {
+                    sounds[i - 1] = sound;
+                } else {
+                    sounds.push_back(sound);
+                    if (sound.id >= index.size()) index.resize(sound.id + 1, 0);
+                    index[sound.id] = (uint16_t) sounds.size();
+                }
+            }
+            auto size = file.size();
+            file.close();
+            reindex();
+            return size;
+        }
+
+        /**
+         * @brief Background task writing the journal's changes into the catalog file once the journal is full
+         */
+        [[noreturn]] void compactLoop() {
+            for (;;) {
+                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+                compact();
+            }
+        }
+
+    public:
+
+        explicit SoundCatalog(Preferences &preferences)
+                : bag(preferences), mutex(xSemaphoreCreateRecursiveMutex()),
+                  fileMutex(xSemaphoreCreateRecursiveMutex()) {
+            assert(mutex != nullptr && fileMutex != nullptr && "Could not create sound catalog mutex");
+        }
+
+        size_t size() const {
+            Lock lock{mutex};
+            return sounds.size();
+        }
+
+        bool empty() const {
+            Lock lock{mutex};
+            return sounds.empty();
+        }
+
+        /**
+         * @brief Returns the revision of the sounds, which changes whenever a sound is added, changed or removed
+         * @return The revision
+         */
+        uint32_t getRevision() const { return revision; }
+
+        /**
+         * @brief Checks whether there is a sound with the given id
+         * @param id The id of the sound
+         * @return true if there is such a sound, false otherwise
+         */
+        bool contains(uint16_t id) const {
+            Lock lock{mutex};
+            return locate(id) != nullptr;
+        }
+
+        /**
+         * @brief Copies the sound with the given id
+         * @param id The id of the sound
+         * @param out The sound to copy the sound to
+         * @return true if the sound was found, false if there is no sound with the given id
+         */
+        bool find(uint16_t id, Sound &out) const {
+            Lock lock{mutex};
+            auto *sound = locate(id);
+            if (sound) out = *sound;
+            return sound != nullptr;
+        }
+
+        /**
+         * @brief Reads the name of the sound with the given id from the catalog file or the journal
+         * @param id The id of the sound
+         * @return The name of the sound or an empty string if there is no sound with the given id
+         */
+        String getName(uint16_t id) const {
+            Lock lock{mutex};
+            auto *sound = locate(id);
+            return sound ? readName(*sound) : String();
+        }
+
+        /**
+         * @brief Adds a sound; the sound is stored in the journal
+         * @param sound The sound to add
+         * @param name The name of the sound
+         * @return true if the sound was added, false if its id is invalid or already taken
+         */
+        bool add(Sound sound, const String &name) {
+            Lock lock{mutex};
+            if (sound.id == 0 || locate(sound.id)) return false;
+            journal(PUT, sound, &name);
+            sounds.push_back(sound);
+            reindex();
+            return true;
+        }
+
+        /**
+         * @brief Changes the name and random setting of a sound; the change is stored in the journal
+         * @param id The id of the sound
+         * @param name The new name of the sound
+         * @param allowRandom Whether the sound may be played randomly
+         * @return true if the sound was changed, false if there is no sound with the given id
+         */
+        bool update(uint16_t id, const String &name, bool allowRandom) {
+            Lock lock{mutex};
+            if (!locate(id)) return false;
+            auto &sound = sounds[index[id] - 1];
+            setFlag(sound, Sound::ALLOW_RANDOM, allowRandom);
+            changed();
+            journal(PUT, sound, name != readName(sound) ? &name : nullptr);
+            return true;
+        }
+
+        /**
+         * @brief Sets whether a sound may be played randomly; the change is stored in the journal
+         * @param id The id of the sound
+         * @param allowRandom Whether the sound may be played randomly
+         * @return true if the sound was changed, false if there is no sound with the given id
+         */
+        bool setAllowRandom(uint16_t id, bool allowRandom) {
+            Lock lock{mutex};
+            if (!locate(id)) return false;
+            auto &sound = sounds[index[id] - 1];
+            setFlag(sound, Sound::ALLOW_RANDOM, allowRandom);
+            changed();
+            journal(PUT, sound);
+            return true;
+        }
+
+        /**
+         * @brief Removes the sound with the given id; the removal is stored in the journal
+         * @param id The id of the sound
+         * @return true if the sound was removed, false if there is no sound with the given id
+         */
+        bool remove(uint16_t id) {
+            Lock lock{mutex};
+            if (!locate(id)) return false;
+            journal(REMOVE, sounds[index[id] - 1]);
+            sounds.erase(sounds.begin() + (index[id] - 1));
+            reindex();
+            return true;
+        }
+
+        /**
+         * @brief Returns the id of the sound the given number of sounds away from the given one, wrapping around
+         * @param id The id to step from
+         * @param steps The number of sounds to step; negative to step backwards
+         * @param withRandom Whether 0, i.e. a random sound, is a step before the first sound
+         * @return The stepped to id; 0 if there are no sounds
+         */
+        uint16_t step(uint16_t id, int steps, bool withRandom) const {
+            Lock lock{mutex};
+            long count = (long) sounds.size() + (withRandom ? 1 : 0);
+            if (sounds.empty()) return 0;
+            long position = 0;
+            if (locate(id)) position = (long) index[id] - (withRandom ? 0 : 1);
+            else if (!withRandom) steps = 0; // start at the first sound
+            position = ((position + steps) % count + count) % count;
+            if (withRandom) return position == 0 ? 0 : sounds[position - 1].id;
+            return sounds[position].id;
+        }
+
+        /**
+         * @brief Draws the next sound from the shuffle bag of the sounds that are allowed to be played randomly,
+         * so no sound is repeated before all of them were played; no memory is allocated and the preferences
+         * are not written, see storeRandom()
+         * @param out The sound to copy the drawn sound to
+         * @return true if a sound was drawn, false if no sound is allowed to be played randomly
+         */
+        bool findRandom(Sound &out) {
+            Lock lock{mutex};
+            auto id = bag.next(sounds.empty() ? 0 : sounds.back().id, [this](uint16_t id) {
+                auto *sound = locate(id);
+                return sound && sound->isAllowRandom() && sound->hasFile();
+            });
+            auto *sound = locate(id);
+            if (sound) out = *sound;
+            return sound != nullptr;
+        }
+
+        /**
+         * @brief Stores the position of the shuffle bag if sounds were drawn since it was stored last\n
+         * Should be called by the main loop, so an alarm's sound is playing before the preferences are written.
+         * The mutex is not held while they are written.
+         */
+        void storeRandom() {
+            ShuffleBag::Position position{};
+            {
+                Lock lock{mutex};
+                if (!bag.isChanged()) return;
+                position = bag.take();
+            }
+            bag.store(position);
+        }
+
+        /**
+         * @brief Reconciles the sounds with the files on the player's SD card\n
+         * The sounds are matched with the files by their folder and track, so a sound keeps its id, name and random
+         * setting when files are added elsewhere. Files without a sound get one with a new id and a default name:
+         * the tracks of the numbered folders, or the global tracks if there are no folders. A sound addressed by its
+         * global track keeps it even if there are folders, as the global tracks count the folders' files as well.
+         * Sounds without a file are kept and only marked, so a card that was swapped or removed temporarily
+         * does not drop the names of its sounds; they are not drawn randomly until their file is back.
+         * @param catalog The files on the SD card as counted by the player
+         * @return true if sounds were added or marked, false otherwise
+         */
+        bool reconcile(const Player::Catalog &catalog) {
+            Lock lock{mutex};
+            // tracks beyond 255 can only be played from the first folders
+            auto playable = [&catalog](uint8_t folder) -> uint16_t {
+                if (folder == 0 || folder > catalog.lastFolder) return 0;
+                auto tracks = catalog.folderFiles[folder - 1];
+                return folder <= (uint8_t) DFPlayerAsync::LARGE_FOLDERS
+                       ? min(tracks, (uint16_t) DFPlayerAsync::LARGE_FOLDER_TRACKS)
+                       : min(tracks, (uint16_t) UINT8_MAX);
+            };
+            auto address = [](uint8_t folder, uint16_t track) { return (uint32_t) folder << 16 | track; };
+
+            bool changed = false;
+            std::vector<uint32_t> addressed; // the addresses that have a sound
+            addressed.reserve(sounds.size());
+            for (auto &sound: sounds) {
+                auto hasFile = sound.folder ? sound.track <= playable(sound.folder) : sound.track <= catalog.files;
+                changed |= hasFile != sound.hasFile();
+                setFlag(sound, Sound::NO_FILE, !hasFile);
+                addressed.push_back(address(sound.folder, sound.track));
+            }
+            std::sort(addressed.begin(), addressed.end());
+
+            auto id = (uint16_t) (sounds.empty() ? 0 : sounds.back().id);
+            auto add = [this, &addressed, &address, &id, &changed](uint8_t folder, uint16_t track) {
+                if (id == UINT16_MAX) return;
+                if (std::binary_search(addressed.begin(), addressed.end(), address(folder, track))) return;
+                sounds.emplace_back(++id, true, folder, track);
+                changed = true;
+            };
+            if (catalog.lastFolder == 0) {
+                for (uint16_t track = 1; track <= catalog.files; ++track) add(0, track);
+            }
+            for (uint8_t folder = 1; folder <= catalog.lastFolder; ++folder) {
+                for (uint16_t track = 1; track <= playable(folder); ++track) add(folder, track);
+            }
+            if (!changed) return false;
+            reindex();
+            return true;
+        }
+
+        static constexpr uint8_t FIELD_ID = BIT0;
+        static constexpr uint8_t FIELD_NAME = BIT1;
+        static constexpr uint8_t FIELD_ALLOW_RANDOM = BIT2;
+        static constexpr uint8_t FIELD_ADDRESS = BIT3; // the folder and track, only if the sound is in a folder
+        static constexpr uint8_t ALL_FIELDS = FIELD_ID | FIELD_NAME | FIELD_ALLOW_RANDOM | FIELD_ADDRESS;
+
+        /**
+         * The maximum length of a serialized sound including the array's header or separator:
+         * a name of 255 characters that are all escaped with six characters in JSON, and the other fields
+         */
+        static constexpr size_t MAX_SERIALIZED_SOUND = 6 * UINT8_MAX + 128;
+
+        /**
+         * @brief The state of a JSON or MessagePack array of sounds that is written in chunks
+         */
+        struct ArrayCursor {
+            size_t position; // the index of the next sound
+            size_t end; // the index after the last sound
+            uint8_t fields;
+            bool msgPack;
+            bool opened{false};
+            bool closed{false};
+            std::array<char, MAX_SERIALIZED_SOUND> pending{}; // the serialized sound that did not fit the last chunk
+            size_t pendingLength{0};
+            size_t pendingSent{0};
+
+            ArrayCursor(size_t offset, size_t limit, uint8_t fields, bool msgPack = false)
+                    : position(offset), end(limit > SIZE_MAX - offset ? SIZE_MAX : offset + limit), fields(fields),
+                      msgPack(msgPack) {}
+        };
+
+        /**
+         * @brief Parses a comma separated list of field names
+         * @param fields The field names: id, name, allowRandom, folder or track
+         * @return The fields; all fields if none of the names is known
+         */
+        static uint8_t parseFields(const String &fields) {
+            uint8_t parsed{0};
+            int start = 0;
+            while (start <= (int) fields.length()) {
+                auto end = fields.indexOf(',', (unsigned int) start);
+                if (end < 0) end = (int) fields.length();
+                auto field = fields.substring(start, end);
+                field.trim();
+                if (field == "id") parsed |= FIELD_ID;
+                else if (field == "name") parsed |= FIELD_NAME;
+                else if (field == "allowRandom") parsed |= FIELD_ALLOW_RANDOM;
+                else if (field == "folder" || field == "track") parsed |= FIELD_ADDRESS;
+                start = end + 1;
+            }
+            return parsed ? parsed : ALL_FIELDS;
+        }
+
+        /**
+         * @brief Creates JSON data from the sound with the given id
+         * @param id The id of the sound
+         * @param json The JSON object to create the JSON data in
+         * @param fields The fields to create
+         * @return true if the sound was found, false if there is no sound with the given id
+         */
+        bool toJson(uint16_t id, const JsonVariant &json, uint8_t fields = ALL_FIELDS) const {
+            Lock lock{mutex};
+            auto *sound = locate(id);
+            if (!sound) return false;
+            if (fields & FIELD_ID) json["id"] = sound->id;
+            if (fields & FIELD_NAME) json["name"] = readName(*sound);
+            if (fields & FIELD_ALLOW_RANDOM) json["allowRandom"] = sound->isAllowRandom();
+            if (fields & FIELD_ADDRESS && sound->folder != 0) {
+                json["folder"] = sound->folder;
+                json["track"] = sound->track;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Writes the next chunk of a JSON or MessagePack array of sounds, serializing one sound at a time;
+         * a sound that does not fit the chunk is continued with the next one\n
+         * The sounds are addressed by their position, so sounds changed between two chunks may be skipped or repeated.
+         * A MessagePack array starts with its length, so it is padded with nil if sounds were removed meanwhile.
+         * @param buffer The buffer to write the chunk to
+         * @param maxLength The size of the buffer
+         * @param cursor The state of the array
+         * @return The length of the chunk; 0 once the array is complete
+         */
+        size_t fillArray(uint8_t *buffer, size_t maxLength, ArrayCursor &cursor) const {
+            Lock lock{mutex};
+            File file;
+            File journal;
+            if (cursor.fields & FIELD_NAME) {
+                file = SPIFFS.open(SOUNDS_FILE_NAME);
+                journal = SPIFFS.open(SOUNDS_JOURNAL_FILE_NAME);
+            }
+            StaticJsonDocument<JSON_SOUND_BUF_SIZE> doc;
+            size_t length = 0;
+            while (length < maxLength) {
+                if (cursor.pendingSent == cursor.pendingLength) {
+                    if (cursor.closed) break;
+                    auto &pending = cursor.pending;
+                    size_t pendingLength = 0;
+                    auto available = cursor.position < min(cursor.end, sounds.size());
+                    if (!cursor.opened && cursor.msgPack) {
+                        // the length of the array is fixed once it is opened
+                        cursor.end = available ? min(cursor.end, sounds.size()) : cursor.position;
+                        auto count = (uint16_t) (cursor.end - cursor.position);
+                        if (count < 16) {
+                            pending[pendingLength++] = (char) (0x90 | count); // fixarray
+                        } else {
+                            pending[pendingLength++] = (char) 0xDC; // array 16
+                            pending[pendingLength++] = (char) (count >> 8);
+                            pending[pendingLength++] = (char) count;
+                        }
+                    } else if (!cursor.opened) {
+                        pending[pendingLength++] = '[';
+                    } else if (available && !cursor.msgPack) {
+                        pending[pendingLength++] = ',';
+                    }
+                    if (available) {
+                        auto &sound = sounds[cursor.position++];
+                        doc.clear();
+                        if (cursor.fields & FIELD_ID) doc["id"] = sound.id;
+                        if (cursor.fields & FIELD_NAME) doc["name"] = readName(file, journal, sound);
+                        if (cursor.fields & FIELD_ALLOW_RANDOM) doc["allowRandom"] = sound.isAllowRandom();
+                        if (cursor.fields & FIELD_ADDRESS && sound.folder != 0) {
+                            doc["folder"] = sound.folder;
+                            doc["track"] = sound.track;
+                        }
+                        auto *out = pending.data() + pendingLength;
+                        auto size = pending.size() - pendingLength;
+                        auto needed = cursor.msgPack ? measureMsgPack(doc) : measureJson(doc);
+                        // the buffers are sized for the longest name, so a sound is never cut off or missing its name
+                        assert(!doc.overflowed() && needed < size && "Sound does not fit the serialization buffer");
+                        auto written = cursor.msgPack ? serializeMsgPack(doc, out, size) : serializeJson(doc, out, size);
+                        assert(written == needed && "Sound was not serialized completely");
+                        pendingLength += written;
+                    } else if (cursor.msgPack && cursor.position < cursor.end) {
+                        pending[pendingLength++] = (char) 0xC0; // nil
+                        ++cursor.position;
+                    } else {
+                        if (!cursor.msgPack) pending[pendingLength++] = ']';
+                        cursor.closed = true;
+                    }
+                    cursor.opened = true;
+                    cursor.pendingLength = pendingLength;
+                    cursor.pendingSent = 0;
+                }
+                auto count = min(maxLength - length, cursor.pendingLength - cursor.pendingSent);
+                memcpy(buffer + length, cursor.pending.data() + cursor.pendingSent, count);
+                length += count;
+                cursor.pendingSent += count;
+            }
+            if (file) file.close();
+            if (journal) journal.close();
+            return length;
+        }
+
+        /**
+         * @brief Loads the sounds from the catalog file and applies the changes of the journal;
+         * imports the JSON sounds file if there is no catalog yet\n
+         * A write of the catalog file that was interrupted by a reset is completed first.
+         * Starts the low priority task that compacts the journal into the catalog file once it is full.
+         * @return true if there are sounds, false otherwise
+         */
+        bool load() {
+            Lock fileLock{fileMutex};
+            Lock lock{mutex};
+            bag.load();
+            if (compactTask == nullptr) {
+                auto result = xTaskCreate(
+                        [](void *catalog) { static_cast<SoundCatalog *>(catalog)->compactLoop(); },
+                        "soundCompact",
+                        4096,
+                        this,
+                        SOUNDS_COMPACT_TASK_PRIORITY,
+                        &compactTask
+                );
+                assert(result == pdPASS && "Could not create sound compaction task");
+            }
+            recover();
+            auto file = SPIFFS.open(SOUNDS_FILE_NAME);
+            if (!file) {
+                if (importJson(JSON_SOUNDS_FILE_NAME)) SPIFFS.remove(JSON_SOUNDS_FILE_NAME);
+                return !sounds.empty();
+            }
+            Header header{};
+            if (readHeader(file, header)) {
+                sounds.resize(header.count);
+                file.read((uint8_t *) sounds.data(), header.count * sizeof(Sound));
+                for (auto &sound: sounds) sound.flags &= (uint8_t) ~Sound::IN_JOURNAL;
+            }
+            file.close();
+            reindex();
+            if (replay() >= SOUNDS_JOURNAL_COMPACT_SIZE) xTaskNotifyGive(compactTask);
+            return !sounds.empty();
+        }
+
+        /**
+         * @brief Replaces all sounds by the sounds of the given JSON file
+         * @param fileName The name of the JSON file to import the sounds from
+         * @return true if the file was imported, false if it does not exist or is malformed
+         */
+        bool importJson(const char *fileName) {
+            auto file = SPIFFS.open(fileName);
+            if (!file) return false;
+            auto imported = importJson(file);
+            file.close();
+            return imported;
+        }
+
+        /**
+         * @brief Replaces all sounds by the sounds of the given JSON array, parsing one sound at a time
+         * @param stream The stream to read the JSON array from, e.g. a file or an uploaded body
+         * @return true if the array was imported, false if it is malformed
+         */
+        bool importJson(Stream &stream) { return import(stream, false); }
+
+        /**
+         * @brief Replaces all sounds by the sounds of the given MessagePack array, parsing one sound at a time
+         * @param stream The stream to read the MessagePack array from, e.g. an uploaded body
+         * @return true if the array was imported, false if it is malformed
+         */
+        bool importMsgPack(Stream &stream) { return import(stream, true); }
+
+        // delete copy constructor and assignment operator
+
+        SoundCatalog(const SoundCatalog &) = delete;
+
+        SoundCatalog &operator=(const SoundCatalog &) = delete;
+
+    };
+
+}
+
+
+#endif //ALARM_CLOCK_SOUND_CATALOG_HPP
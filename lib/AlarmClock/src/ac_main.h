@@ -14,15 +14,7 @@ namespace AlarmClock {
      * The main setup of the alarm clock; sets up the alarm clock and all its components
      */
     void setup() {
-        static const ESP32_Timer rtcTimer{
-                "RTC Timer",
-                1000,
-                true,
-                []() {
-                    auto dt = AC.rtc.now();
-                    if (dt.isValid()) AC.now = dt;
-                }
-        };
+        scheduler::setup();
 
         auto &ui = AC.ui;
         ui.setup();
@@ -40,8 +32,9 @@ namespace AlarmClock {
 
         ui.drawBootAnimation(20, "Initializing RTC");
         assert(rtc::setup() && "RTC failed to initialize");
-        rtcTimer.start();
-        rtc::attachInterrupt(RTC_SQW_PIN, []() { AC.anyAlarmTriggered = true; });
+        setupAlarmTask();
+        timebase::setup(AC.rtc, RTC_SQW_PIN, onAlarmInterrupt);
+        AC.now = timebase::now();
 
         ui.drawBootAnimation(25, "Initializing Touchpad");
         navigation::setup();
@@ -49,13 +42,18 @@ namespace AlarmClock {
         ui.drawBootAnimation(35, "Connecting WiFi");
         esp32_wifi::setup([]() { ui.drawBootAnimation(40, "Running SmartConfig"); });
         AC.tz.load();
+        AC.publishTimeZone();
         esp32_wifi::setupNTP([](struct timeval *) { rtc::adjustTimeFromInternalRTC(); }, ((String) AC.tz).c_str());
 
         ui.drawBootAnimation(45, "Initializing Webserver");
+        commands::setup();
         webserver::setup();
 
         ui.drawBootAnimation(50, "Initializing Light Sensor");
-        assert(AC.lightSensor.setup() && "Light sensor failed to initialize");
+        {
+            I2CBus::Transaction transaction{i2c::lightSensor};
+            assert(AC.lightSensor.setup() && "Light sensor failed to initialize");
+        }
 
         ui.drawBootAnimation(55, "Initializing Main Light");
         AC.mainLight.setup();
@@ -63,11 +61,13 @@ namespace AlarmClock {
         ui.drawBootAnimation(65, "Initializing Indicator Light");
         AC.indicatorLight.setup();
 
-        ui.drawBootAnimation(70, "Initializing DFPlayer");
-        assert(AC.player.setup() && "Player failed to initialize");
+        ui.drawBootAnimation(70, "Loading sounds");
+        AC.sounds.load();
 
-        ui.drawBootAnimation(75, "Loading sounds");
-        AC.sounds = Sound::loadSounds(JSON_SOUNDS_FILE_NAME);
+        ui.drawBootAnimation(75, "Initializing DFPlayer");
+        AC.player.onCatalog([]() { scheduler::notify(scheduler::SOUND_CATALOG); });
+        AC.player.onEvent(onPlayerEvent);
+        assert(AC.player.setup() && "Player failed to initialize");
 
         ui.drawBootAnimation(85, "Alarms");
         setupAlarm(AC.alarm1);
@@ -78,10 +78,10 @@ namespace AlarmClock {
         ui.drawBootAnimation(90, "Setting UI Frames");
         ui.setFrames(
                 UIDisplay::Frame{FRAME_CALLBACK(home), uiHome}, // 0
-                UIDisplay::Frame{FRAME_CALLBACK(alarm), uiAlarm}, // 1
+                UIDisplay::Frame{FRAME_CALLBACK(alarm), uiAlarm, Refresh::Animated}, // 1
                 UIDisplay::Frame{FRAME_CALLBACK(snoozeAlarm), uiAlarmSnooze}, // 2
                 UIDisplay::Frame{FRAME_CALLBACK(defuseAlarm), uiAlarmDefuse}, // 3
-                UIDisplay::Frame{FRAME_CALLBACK(overview), uiOverview}, // 4
+                UIDisplay::Frame{FRAME_CALLBACK(overview), uiOverview, Refresh::EverySecond}, // 4
                 UIDisplay::Frame{FRAME_CALLBACK(settings), uiSettings}, // 5
                 UIDisplay::Frame{FRAME_CALLBACK(alarmMenu), uiAlarmMenu}, // 6
                 UIDisplay::Frame{FRAME_CALLBACK(alarmTime), uiAlarmTime}, // 7
@@ -91,9 +91,9 @@ namespace AlarmClock {
                 UIDisplay::Frame{FRAME_CALLBACK(playerPlay), uiPlayerPlay}, // 11
                 UIDisplay::Frame{FRAME_CALLBACK(playerSounds), uiPlayerSounds}, // 12
                 UIDisplay::Frame{FRAME_CALLBACK(lightDuration), uiLightDuration}, // 13
-                UIDisplay::Frame{FRAME_CALLBACK(wifiMenu), uiWiFiMenu}, // 14
+                UIDisplay::Frame{FRAME_CALLBACK(wifiMenu), uiWiFiMenu, Refresh::EverySecond}, // 14
                 UIDisplay::Frame{FRAME_CALLBACK(smartConfig), uiSmartConfig}, // 15
-                UIDisplay::Frame{FRAME_CALLBACK(info), uiInfo} // 16
+                UIDisplay::Frame{FRAME_CALLBACK(info), uiInfo, Refresh::EverySecond} // 16
         );
 
         ui.drawBootAnimation(95, "Boot finished");
@@ -101,44 +101,102 @@ namespace AlarmClock {
     }
 
     /**
-     * The main loop of the alarm clock
+     * The main loop of the alarm clock\n
+     * Sleeps until an event is posted to the scheduler or the next periodic work is due,
+     * i.e. an animation needs its next frame.
      */
     void loop() {
         static auto &matrix = AC.matrix;
         static auto &lightLevel = AC.lightLevel;
         static bool matrixIlluminate{false};
+        static bool matrixIdle{false};
+        static uint32_t timeout{0};
         static const ESP32_Timer matrixIlluminateTimer{
                 "Matrix Illuminate Timer",
                 5000,
                 false,
                 []() { matrixIlluminate = false; }
         };
+        static const ESP32_Timer lightSensorTimer{
+                "Light Sensor Timer",
+                LIGHT_SENSOR_INTERVAL,
+                true,
+                []() { scheduler::notify(scheduler::LIGHT_SENSOR); }
+        };
         // callback to illuminate the matrix
         static const auto illuminateMatrix = []() {
             matrixIlluminate = true;
             matrixIlluminateTimer.start();
         };
 
-        // alarm handle
-        handleAlarms();
+        if (timeout == 0) lightSensorTimer.start();
+        auto events = scheduler::wait(timeout);
 
-        matrix.loop();
+        // touch events are posted by the touch subsystem, so only wake up for periodic work
+        timeout = UINT32_MAX;
 
-        if (lightLevel < 1e-3 && !matrixIlluminate && navigation::read() != navigation::Direction::None) {
-            illuminateMatrix();
-        } else {
-            // if the ui is animating, don't do anything else
-            if (!AC.ui.loop()) return;
+        // the web server queued changes, which are applied here, as the main loop owns the state
+        if (events & scheduler::WEB_COMMAND) commands::applyAll();
+
+        // state changed outside of the ui handles, so redraw the current frame
+        if (events & (scheduler::UI_UPDATE | scheduler::WEB_COMMAND)) AC.ui.invalidate();
+
+        // the ui timer expired, so return to the home frame
+        if (events & scheduler::UI_TIMEOUT) AC.ui.transitionToFrame(0);
+
+        // the time base ticked, so take over the new time and let the matrix and the ui show it
+        if (events & scheduler::TIME_TICK) {
+            timebase::verify(AC.rtc);
+            AC.now = timebase::now();
+            matrix.invalidate();
+            AC.ui.tick();
+        }
+
+        // the player counted the files on its SD card, so each of them gets a sound
+        if (events & scheduler::SOUND_CATALOG && AC.sounds.reconcile(AC.player.getCatalog())) {
+            AC.ui.invalidate();
         }
 
-        // handle light sensor and matrix illumination
-        if (AC.lightSensor.tryReading()) {
+        // alarm handle
+        if (events & scheduler::ALARM_TRIGGERED) profiler::measure(profiler::Stage::Alarms, handleAlarms);
+
+        // a random sound was drawn by the alarm task, the ui or a command, so store the shuffle bag's position
+        if (events) AC.sounds.storeRandom();
+
+        // push the state changed by any of the events to the clients of the web server's event source
+        if (events) webserver::pushChanges();
+
+        // the matrix only needs to be updated when the time changed or while it is animating
+        if (events & scheduler::TIME_TICK || !matrixIdle || matrix.isScrolling()) {
+            matrixIdle = profiler::measure(profiler::Stage::Matrix, []() { return matrix.loop(); });
+        }
+        if (!matrixIdle) timeout = MATRIX_FRAME_INTERVAL;
+
+        // handle light sensor and matrix illumination before the ui, which returns early while it is animating,
+        // as the event is already consumed
+        if (events & scheduler::LIGHT_SENSOR &&
+            profiler::measure(profiler::Stage::LightSensor, []() {
+                I2CBus::Transaction transaction{i2c::lightSensor};
+                return AC.lightSensor.tryReading();
+            })) {
             auto value = AC.lightSensor.getValue();
             if (lightLevel > 1e-3 && value < 1e-3) illuminateMatrix();
             lightLevel = value;
             matrix.setBrightness((uint8_t) (0.1005 * lightLevel - 0.05));
             matrix.shutdown(!AC.uiActive && lightLevel == 0 && !matrixIlluminate && !AC.mainLight.getDuty());
         }
+
+        if (lightLevel < 1e-3 && !matrixIlluminate &&
+            profiler::measure(profiler::Stage::Navigation, []() { return navigation::read(); }) != navigation::Direction::None) {
+            illuminateMatrix();
+        } else {
+            // if the ui is animating, don't do anything else, but wake up for the transition's next frame
+            if (!profiler::measure(profiler::Stage::UI, []() { return AC.ui.loop(); })) {
+                timeout = min(timeout, AC.ui.nextUpdateIn());
+                return;
+            }
+        }
+        timeout = min(timeout, AC.ui.nextUpdateIn());
     }
 
 }
@@ -48,7 +48,7 @@ namespace AlarmClock {
         Uint8Bean minute; // 0-59
         Uint8Bean repeat; // 0-127 - a bit for each day of the week, starting with Sunday
         BoolBean toggle; // true or false
-        Uint8Bean sound; // 0-255
+        Uint16Bean sound; // the id of the sound or 0 for a random sound
         AlarmState state{AlarmState::OFF};
 
         Alarm(N n, Preferences &preferences) :
@@ -57,7 +57,7 @@ namespace AlarmClock {
                 minute{n == N::ONE ? "A1M" : "A2M", preferences},
                 repeat{n == N::ONE ? "A1R" : "A2R", preferences},
                 toggle{n == N::ONE ? "A1T" : "A2T", preferences},
-                sound{n == N::ONE ? "A1S" : "A2S", preferences} {}
+                sound{n == N::ONE ? "A1Snd" : "A2Snd", preferences} {}
 
         // deleted copy constructor and assignment operator
 
@@ -66,6 +66,31 @@ namespace AlarmClock {
         Alarm &operator=(const Alarm &) = delete;
     };
 
+    /**
+     * The mutex guarding the state and settings of both alarms, which are changed by the alarm task,
+     * the alarm turn off timer and the main loop
+     */
+    const SemaphoreHandle_t alarmMutex{xSemaphoreCreateRecursiveMutex()};
+
+    /**
+     * Guard holding the alarm mutex for its lifetime
+     */
+    class AlarmLock {
+
+    public:
+
+        AlarmLock() { xSemaphoreTakeRecursive(alarmMutex, portMAX_DELAY); }
+
+        ~AlarmLock() { xSemaphoreGiveRecursive(alarmMutex); }
+
+        // delete copy constructor and assignment operator
+
+        AlarmLock(const AlarmLock &) = delete;
+
+        AlarmLock &operator=(const AlarmLock &) = delete;
+
+    };
+
 
     //#region Alarm specific functions
 
@@ -78,7 +103,8 @@ namespace AlarmClock {
         alarm.minute.load();
         alarm.repeat.load();
         alarm.toggle.load();
-        alarm.sound.load();
+        // the sound was stored as 8-bit id before
+        alarm.sound.migrate(alarm.n == N::ONE ? "A1S" : "A2S", &Preferences::getUChar);
     }
 
     /**
@@ -151,24 +177,11 @@ namespace AlarmClock {
         json["minute"] = (uint8_t) alarm.minute;
         json["repeat"] = (uint8_t) alarm.repeat;
         json["toggle"] = (bool) alarm.toggle;
-        json["sound"] = (uint8_t) alarm.sound;
+        json["sound"] = (uint16_t) alarm.sound;
         auto alarmTime = getAlarmTime(alarm, now);
         json["nextDateTime"] = alarmTime != DateTime() ? alarmTime.unixtime() : 0;
     }
 
-    /**
-     * Parses the given JsonVariant to an alarm
-     * @param alarm The alarm to parse the Json to
-     * @param json The JsonVariant to parse
-     */
-    void alarmFromJson(Alarm &alarm, const JsonVariant &json) {
-        alarm.hour = (uint8_t) json["hour"];
-        alarm.minute = (uint8_t) json["minute"];
-        alarm.repeat = (uint8_t) json["repeat"];
-        alarm.toggle = (bool) json["toggle"];
-        alarm.sound = (uint8_t) json["sound"];
-    }
-
     //#endregion
     //#region DS3231 functions
 
@@ -178,6 +191,7 @@ namespace AlarmClock {
      * @param rtc The DS3231 RTC
      */
     void disableAlarm(const Alarm &alarm, RTC_DS3231 &rtc) {
+        I2CBus::Transaction transaction{i2c::rtc};
         rtc.disableAlarm(nToInt(alarm.n));
     }
 
@@ -188,14 +202,16 @@ namespace AlarmClock {
      * @return True if the alarm was set successfully, false otherwise
      */
     bool setAlarm(const Alarm &alarm, RTC_DS3231 &rtc) {
+        I2CBus::Transaction transaction{i2c::rtc};
         rtc.clearAlarm(nToInt(alarm.n));
 
-        auto alarmTime = getAlarmTime(alarm, rtc.now());
+        auto alarmTime = getAlarmTime(alarm, timebase::now());
         if (alarmTime == DateTime()) {
             disableAlarm(alarm, rtc);
             return true;
         }
 
+        timebase::AlarmAccess access{rtc};
         switch (alarm.n) {
             case N::ONE:
                 return rtc.setAlarm1(alarmTime, DS3231_A1_Date);
@@ -214,6 +230,7 @@ namespace AlarmClock {
      */
     bool readAlarm(Alarm &alarm, RTC_DS3231 &rtc) {
         auto n = nToInt(alarm.n);
+        I2CBus::Transaction transaction{i2c::rtc};
         if (rtc.alarmFired(n)) {
             alarm.state = AlarmState::PLAYING;
             rtc.clearAlarm(n);
@@ -230,9 +247,11 @@ namespace AlarmClock {
      * @return True if the alarm was snoozed successfully, false otherwise
      */
     bool snoozeAlarm(Alarm &alarm, RTC_DS3231 &rtc, int8_t minutes) {
-        auto alarmTime = rtc.now() + TimeSpan(0, 0, minutes, 0);
+        auto alarmTime = timebase::now() + TimeSpan(0, 0, minutes, 0);
+        I2CBus::Transaction transaction{i2c::rtc};
         rtc.clearAlarm(nToInt(alarm.n));
         bool success;
+        timebase::AlarmAccess access{rtc};
         switch (alarm.n) {
             case N::ONE:
                 success = rtc.setAlarm1(alarmTime, DS3231_A1_Date);
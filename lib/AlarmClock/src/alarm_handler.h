@@ -10,6 +10,17 @@ namespace AlarmClock {
 
     void stopAlarms();
 
+    volatile bool alarmLatencyPending{false}; // an alarm was started, but the player did not acknowledge its sound yet
+
+    /**
+     * @brief Lets the time base poll the alarms on every tick while any alarm is snoozed,
+     * as a snoozed alarm may go off at any second instead of only on full minutes
+     */
+    void updateAlarmPolling() {
+        AlarmLock lock{};
+        timebase::pollEverySecond = AC.alarm1.state == AlarmState::SNOOZED || AC.alarm2.state == AlarmState::SNOOZED;
+    }
+
     const ESP32_Timer alarmTurnOffTimer{
             "Turn Off Timer",
             30 * 60 * 1000 /* 30 min */,
@@ -25,6 +36,8 @@ namespace AlarmClock {
      * at the next time it is supposed to go off.
      */
     void stopAlarms() {
+        AlarmLock lock{};
+        alarmLatencyPending = false;
         AC.player.stop();
         AC.indicatorLight.toggleOff();
         if (AC.alarm1.state == AlarmState::PLAYING || AC.alarm1.state == AlarmState::SNOOZED) {
@@ -48,6 +61,7 @@ namespace AlarmClock {
             }
         }
         alarmTurnOffTimer.stop();
+        updateAlarmPolling();
     }
 
     /**
@@ -57,6 +71,8 @@ namespace AlarmClock {
      * as snooze itself is set as an alarm and would otherwise be stopped by the turn off timer.
      */
     void snoozeAlarms() {
+        AlarmLock lock{};
+        alarmLatencyPending = false;
         AC.player.stop();
         AC.indicatorLight.setDuty(1);
         alarmTurnOffTimer.stop();
@@ -68,36 +84,117 @@ namespace AlarmClock {
             snoozeAlarm(AC.alarm2, AC.rtc, (int8_t) AC.snoozeTime)) {
             AC.alarm2.state = AlarmState::SNOOZED;
         }
+        updateAlarmPolling();
     }
 
+    TaskHandle_t alarmTask{nullptr};
+    volatile int64_t alarmInterruptTime{0}; // µs since boot
+
     /**
-     * @brief Handles alarm triggers\n
-     * Should be called when the RTC alarm interrupt is triggered. Reads both alarms and handles them accordingly,
-     * i.e. plays the alarm sound, turns on the indicator light and the main light and switches to the alarm frame.
-     * Also starts the alarm turn off timer to disable the alarm after 30 minutes and sets the defuse code.
+     * @brief Called by the time base's tick ISR on ticks the alarms need to be polled on;
+     * notifies the alarm task to check for and start triggered alarms
      */
-    void handleAlarms() {
-        if (!AC.anyAlarmTriggered) return;
-        AC.anyAlarmTriggered = false;
+    void IRAM_ATTR onAlarmInterrupt() {
+        BaseType_t higherPriorityTaskWoken = pdFALSE;
+        alarmInterruptTime = esp_timer_get_time();
+        vTaskNotifyGiveFromISR(alarmTask, &higherPriorityTaskWoken);
+        if (higherPriorityTaskWoken) portYIELD_FROM_ISR();
+    }
+
+    /**
+     * @brief Called by the player's task on player events; records the latency between the alarm interrupt and
+     * the player's acknowledgement of the alarm sound, as playing a sound only enqueues the command
+     */
+    void onPlayerEvent(DFPlayerAsync::Event event, uint16_t param) {
+        if (event != DFPlayerAsync::Event::Acknowledged || !alarmLatencyPending) return;
+        switch (param) {
+            case DFPlayerAsync::PLAY_TRACK:
+            case DFPlayerAsync::LOOP_TRACK:
+            case DFPlayerAsync::PLAY_FOLDER:
+            case DFPlayerAsync::PLAY_LARGE_FOLDER:
+                break;
+            default:
+                return;
+        }
+        alarmLatencyPending = false;
+        auto latency = (uint64_t) (esp_timer_get_time() - alarmInterruptTime); // µs
+        profiler::alarmLatency.record(latency * ESP.getCpuFreqMHz());
+    }
+
+    /**
+     * @brief Plays the given alarm sound in a loop
+     * @param id The id of the sound; 0 for a random sound; the first track is played if the sound does not exist
+     */
+    void playAlarmSound(uint16_t id) {
+        Sound sound{};
+        if (id == 0 ? AC.sounds.findRandom(sound) : AC.sounds.find(id, sound)) AC.player.playLoop(sound);
+        else AC.player.playLoop((uint16_t) 1);
+    }
+
+    /**
+     * @brief Starts the triggered alarms\n
+     * Runs in the alarm task, so only the time-critical part of an alarm is done here: reads both alarms,
+     * plays the alarm sound, turns on the indicator light and the main light and starts the alarm turn off timer
+     * to disable the alarm after 30 minutes. The latency until the sound starts is recorded by onPlayerEvent().
+     * @return True if any alarm was triggered, false otherwise
+     */
+    bool startAlarms() {
+        AlarmLock lock{};
+        bool triggered{false};
         if (readAlarm(AC.alarm1, AC.rtc)) {
-            auto sound = (uint8_t) AC.alarm1.sound;
-            if (sound == 0) AC.player.playLoop(Sound::findRandomSound(AC.sounds).getId());
-            else AC.player.playLoop(sound);
+            alarmLatencyPending = true;
+            playAlarmSound((uint16_t) AC.alarm1.sound);
+            triggered = true;
         }
         if (readAlarm(AC.alarm2, AC.rtc)) {
-            auto sound = (uint8_t) AC.alarm2.sound;
-            if (sound == 0) AC.player.playLoop(Sound::findRandomSound(AC.sounds).getId());
-            else AC.player.playLoop(sound);
+            alarmLatencyPending = true;
+            playAlarmSound((uint16_t) AC.alarm2.sound);
+            triggered = true;
         }
+        if (!triggered) return false;
         alarmTurnOffTimer.start();
         AC.indicatorLight.toggleOn();
         AC.mainLight.toggleOn();
+        return true;
+    }
+
+    /**
+     * @brief Creates the alarm task, which is pinned to the application core and prioritized above the main loop,
+     * so an alarm is started without waiting for the ui, the display or any other work of the main loop\n
+     * Must be called before the time base is set up.
+     */
+    void setupAlarmTask() {
+        auto result = xTaskCreatePinnedToCore(
+                [](void *) {
+                    for (;;) {
+                        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+                        if (startAlarms()) {
+                            updateAlarmPolling();
+                            scheduler::notify(scheduler::ALARM_TRIGGERED);
+                        }
+                    }
+                },
+                "alarm",
+                4096,
+                nullptr,
+                ALARM_TASK_PRIORITY,
+                &alarmTask,
+                ALARM_TASK_CORE
+        );
+        assert(result == pdPASS && "Could not create alarm task");
+    }
+
+    /**
+     * @brief Handles alarm triggers in the ui\n
+     * Should be called by the main loop after the alarm task started an alarm.
+     * Switches to the alarm frame, sets the defuse code and stops the ui timer.
+     */
+    void handleAlarms() {
         AC.ui.transitionToFrame(1); // alarm frame
         for (auto &i: AC.defuseCode) i = (uint8_t) random(4);
         AC.uiTimer.stop();
     }
 
-
 }
 
 
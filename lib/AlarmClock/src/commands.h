@@ -0,0 +1,175 @@
+#ifndef ALARM_CLOCK_COMMANDS_H
+#define ALARM_CLOCK_COMMANDS_H
+
+
+namespace AlarmClock {
+    namespace commands {
+
+        /**
+         * The changes the web server can request; each is applied by the main loop
+         */
+        enum class Type : uint8_t {
+            SetTimeZone, SetAlarm, SetAlarmIn8h, SetLight, SetVolume, Play, Stop,
+            ImportSounds, AddSound, UpdateSound, RemoveSound
+        };
+
+        struct AlarmSettings {
+            uint8_t id; // 1 or 2
+            uint8_t hour;
+            uint8_t minute;
+            uint8_t repeat;
+            bool toggle;
+            uint16_t sound;
+        };
+
+        struct LightSettings {
+            uint8_t duty;
+            uint8_t duration;
+        };
+
+        struct SoundSettings {
+            uint16_t id; // 0 to play a random sound
+            bool allowRandom;
+            uint8_t folder;
+            uint16_t track;
+        };
+
+        struct UploadSettings {
+            uint8_t *data; // taken over from the request and freed once the command was applied
+            size_t length;
+            bool msgPack; // MessagePack instead of JSON, as told by the content type
+        };
+
+        /**
+         * A command with its arguments; copied into the queue as is, so it holds no pointers to the request
+         * apart from an uploaded body it took over
+         */
+        struct Command {
+            Type type;
+            union {
+                AlarmSettings alarm;
+                LightSettings light;
+                uint8_t volume;
+                SoundSettings sound;
+                UploadSettings upload;
+            };
+            std::array<char, UINT8_MAX + 1> text; // the time zone or the name of the sound
+
+            explicit Command(Type type) : type(type), sound(), text() {}
+
+            void setText(const char *value) {
+                strncpy(text.data(), value ? value : "", text.size() - 1);
+                text.back() = '\0';
+            }
+        };
+
+        QueueHandle_t queue{nullptr};
+        std::atomic<bool> importPending{false}; // whether uploaded sounds are queued, so only one upload is held in RAM
+
+        /**
+         * Creates the command queue; must be called before the web server is set up
+         */
+        void setup() {
+            queue = xQueueCreate(WEB_COMMAND_QUEUE_SIZE, sizeof(Command));
+            assert(queue != nullptr && "Could not create command queue");
+        }
+
+        /**
+         * Queues a command and wakes up the main loop to apply it\n
+         * Called by the web server's handlers, which validate the request beforehand and do not wait for the command,
+         * so the network stack is not blocked by the I2C, UART, NVS and flash access of the changes.
+         * @param command The command
+         * @return true if the command was queued, false if the queue is full
+         */
+        bool submit(const Command &command) {
+            if (xQueueSend(queue, &command, 0) != pdTRUE) return false;
+            scheduler::notify(scheduler::WEB_COMMAND);
+            return true;
+        }
+
+        /**
+         * Applies a single command
+         * @param command The command
+         * @return true if the command succeeded, false otherwise
+         */
+        bool apply(const Command &command) {
+            switch (command.type) {
+                case Type::SetTimeZone:
+                    if (setenv("TZ", command.text.data(), 1) != 0) return false;
+                    tzset();
+                    AC.tz = command.text.data();
+                    AC.publishTimeZone();
+                    return true;
+                case Type::SetAlarm:
+                case Type::SetAlarmIn8h: {
+                    AlarmLock lock{};
+                    auto &alarm = command.alarm.id == 1 ? AC.alarm1 : AC.alarm2;
+                    if (command.type == Type::SetAlarmIn8h) {
+                        setIn8hFromNow(alarm, AC.now.load());
+                    } else {
+                        alarm.hour = command.alarm.hour;
+                        alarm.minute = command.alarm.minute;
+                        alarm.repeat = command.alarm.repeat;
+                        alarm.toggle = command.alarm.toggle;
+                        alarm.sound = command.alarm.sound;
+                    }
+                    return setAlarm(alarm, AC.rtc);
+                }
+                case Type::SetLight:
+                    AC.mainLight.setDuty(command.light.duty);
+                    AC.mainLight.setDuration(command.light.duration);
+                    return true;
+                case Type::SetVolume:
+                    AC.player.setVolume(command.volume);
+                    return true;
+                case Type::Play: {
+                    Sound sound{};
+                    auto found = command.sound.id == 0 ? AC.sounds.findRandom(sound)
+                                                       : AC.sounds.find(command.sound.id, sound);
+                    if (found) AC.player.play(sound);
+                    else if (command.sound.id == 0) AC.player.play((uint16_t) 1);
+                    return found || command.sound.id == 0;
+                }
+                case Type::Stop:
+                    AC.player.stop();
+                    return true;
+                case Type::ImportSounds: {
+                    MemoryStream stream{command.upload.data, command.upload.length};
+                    auto imported = command.upload.msgPack ? AC.sounds.importMsgPack(stream)
+                                                           : AC.sounds.importJson(stream);
+                    free(command.upload.data);
+                    importPending = false;
+                    if (!imported) return false;
+                    // the player's files decide which sounds exist once they were counted
+                    auto catalog = AC.player.getCatalog();
+                    if (catalog.files != 0) AC.sounds.reconcile(catalog);
+                    return true;
+                }
+                case Type::AddSound:
+                    return AC.sounds.add(
+                            Sound{command.sound.id, command.sound.allowRandom, command.sound.folder, command.sound.track},
+                            command.text.data()
+                    );
+                case Type::UpdateSound:
+                    // the sound keeps its address on the player's SD card
+                    return AC.sounds.update(command.sound.id, command.text.data(), command.sound.allowRandom);
+                case Type::RemoveSound:
+                    return AC.sounds.remove(command.sound.id);
+            }
+            return false;
+        }
+
+        /**
+         * Applies all queued commands\n
+         * Should be called by the main loop, which owns the alarm clock's state, when a web command was posted.
+         */
+        void applyAll() {
+            Command command{Type::Stop};
+            while (xQueueReceive(queue, &command, 0) == pdTRUE) apply(command);
+        }
+
+    }
+}
+
+
+#endif //ALARM_CLOCK_COMMANDS_H
@@ -17,12 +17,46 @@ constexpr auto TOUCHPAD_RIGHT_PIN = 27;
 constexpr auto TOUCHPAD_UP_PIN = 32;
 constexpr auto TOUCHPAD_DOWN_PIN = 33;
 constexpr auto SERVER_PORT = 8181;
-constexpr auto JSON_SOUNDS_BUF_SIZE = 8192;
+// a single sound with a name of up to 255 characters and its copied keys, the sounds are read and written one at a time
+constexpr auto JSON_SOUND_BUF_SIZE = JSON_OBJECT_SIZE(5) + JSON_STRING_SIZE(UINT8_MAX) + 64;
+constexpr auto JSON_METRICS_BUF_SIZE = 4096;
+constexpr auto JSON_EVENT_BUF_SIZE = 256; // a single pushed state change
+constexpr auto JSON_STATE_BUF_SIZE = 3072;
+constexpr auto JSON_DOCUMENT_BUF_SIZE = 1024; // the default size of a web API document
+constexpr auto JSON_BODY_MAX_SIZE = 1024; // bytes
+constexpr auto SOUNDS_UPLOAD_MAX_SIZE = 65536; // bytes of uploaded sounds held in RAM, about 1000 sounds
+constexpr auto MSGPACK_CONTENT_TYPE = "application/msgpack";
+constexpr auto EVENT_LIGHT_LEVEL_THRESHOLD = 0.1f; // the relative light level change that is pushed
 constexpr auto OLED_ADDRESS = 0x3C;
-constexpr auto JSON_SOUNDS_FILE_NAME = "/sounds.json";
+constexpr auto RTC_ADDRESS = 0x68;
+constexpr auto LIGHT_SENSOR_ADDRESS = 0x23;
+constexpr auto I2C_FREQUENCY = 400000; // Hz
+constexpr auto OLED_I2C_FREQUENCY = 1000000; // Hz
+constexpr auto JSON_SOUNDS_FILE_NAME = "/sounds.json"; // only imported once if there is no sound catalog yet
+constexpr auto SOUNDS_FILE_NAME = "/sounds.bin";
+constexpr auto SOUNDS_TMP_FILE_NAME = "/sounds.bin.tmp";
+constexpr auto SOUNDS_NAMES_FILE_NAME = "/sounds.str";
+constexpr auto SOUNDS_JOURNAL_FILE_NAME = "/sounds.log";
+constexpr auto SOUNDS_JOURNAL_COMPACT_SIZE = 4096; // bytes
 constexpr auto NTP_SERVER_1 = "pool.ntp.org";
 constexpr auto NTP_SERVER_2 = "time.nist.gov";
 constexpr auto NTP_SERVER_3 = "time.google.com";
 constexpr auto PREFERENCES_NAMESPACE = "AlarmClock";
+constexpr auto TIME_ZONE_MAX_LENGTH = 63; // characters of a POSIX time zone string
+constexpr auto TOUCH_RELEASE_TIMEOUT = 100; // ms
+constexpr auto TOUCH_TRACK_INTERVAL = 1000; // ms
+constexpr auto TOUCH_EVENT_QUEUE_SIZE = 8;
+constexpr auto TOUCH_PERSIST_INTERVAL = 600000; // ms
+constexpr auto TOUCH_PERSIST_DRIFT = 0.02f; // relative baseline change required to persist the calibration
+constexpr auto SOUND_DOUBLE_TAP_STEPS = 10; // the sounds a double tap of up or down steps in the sound frames
+constexpr auto MATRIX_FRAME_INTERVAL = 10; // ms
+constexpr auto LIGHT_SENSOR_INTERVAL = 200; // ms
+constexpr auto TIME_VERIFY_INTERVAL = 600; // s
+constexpr auto ALARM_TASK_PRIORITY = 5;
+constexpr auto ALARM_TASK_CORE = 1;
+constexpr auto SOUNDS_COMPACT_TASK_PRIORITY = 1;
+constexpr auto WEB_COMMAND_QUEUE_SIZE = 8;
+constexpr auto WEB_EVENTS_PER_PUSH = 7; // time, light sensor, both alarms, light, player and sounds
+constexpr auto WEB_EVENT_QUEUE_SIZE = 2 * WEB_EVENTS_PER_PUSH;
 
 #endif //ALARM_CLOCK_CONSTANTS_H
@@ -0,0 +1,48 @@
+#ifndef ALARM_CLOCK_I2C_H
+#define ALARM_CLOCK_I2C_H
+
+
+namespace AlarmClock {
+    namespace i2c {
+
+        /**
+         * The I2C bus shared by the display, the RTC and the light sensor\n
+         * Every access to one of the devices has to be done within a transaction on its device.
+         */
+        I2CBus bus{Wire};
+        I2CBus::Device rtc{bus, "DS3231", RTC_ADDRESS, I2C_FREQUENCY};
+        I2CBus::Device lightSensor{bus, "BH1750", LIGHT_SENSOR_ADDRESS, I2C_FREQUENCY};
+        I2CBus::Device oled{bus, "SSD1306", OLED_ADDRESS, OLED_I2C_FREQUENCY, true};
+
+        /**
+         * Creates JSON data from the statistics of all devices on the bus
+         * @param json The JSON object to create the JSON data in
+         */
+        void toJson(const JsonVariant &json) {
+            for (auto device: bus.getDevices()) {
+                auto &stats = device->getStats();
+                auto deviceJson = json.createNestedObject(device->getName());
+                deviceJson["address"] = device->getAddress();
+                deviceJson["frequency"] = device->getFrequency();
+                deviceJson["transactions"] = stats.transactions;
+                if (device->countsTransfers()) {
+                    // RTClib and the BH1750 driver use the wire on their own, so only the display is counted
+                    deviceJson["bytes"] = stats.bytes;
+                    deviceJson["nacks"] = stats.nacks;
+                }
+                deviceJson["meanUs"] = stats.transactions ? (uint32_t) (stats.totalUs / stats.transactions) : 0;
+                deviceJson["maxUs"] = stats.maxUs;
+                deviceJson["maxWaitUs"] = stats.maxWaitUs;
+            }
+        }
+
+        /**
+         * Resets the statistics of all devices on the bus
+         */
+        void reset() { for (auto device: bus.getDevices()) device->resetStats(); }
+
+    }
+}
+
+
+#endif //ALARM_CLOCK_I2C_H
@@ -22,57 +22,251 @@ namespace AlarmClock {
         };
 
         /**
-         * Nav pad struct containing the direction and the touchpad
+         * The gestures the navigation reports\n
+         * Each gesture is a bit, so the ui handles can opt into the gestures they want to receive by a mask.
+         */
+        enum Gesture : uint8_t {
+            PRESS = BIT0, // a pad was pressed
+            RELEASE = BIT1, // a pad was released
+            LONG_PRESS = BIT2, // a pad is held for the long press time
+            REPEAT = BIT3, // a pad is held and repeats its press with an accelerating rate
+            DOUBLE_TAP = BIT4 // a pad was pressed again shortly after a tap; reported as press if not opted in
+        };
+
+        /**
+         * The timing of the gestures\n
+         * The default repeats only the up and down pads, as repeating is only useful to change values.
+         */
+        struct Config {
+            uint32_t longPressTime{600}; // ms
+            uint32_t doubleTapTime{300}; // ms
+            uint32_t repeatDelay{500}; // ms
+            uint32_t repeatInterval{250}; // ms
+            uint32_t minRepeatInterval{30}; // ms
+            float repeatAcceleration{0.85f}; // the factor the repeat interval is multiplied with after each repeat
+            uint8_t repeatDirections{1 << (uint8_t) Direction::Up | 1 << (uint8_t) Direction::Down};
+        } config;
+
+        /**
+         * A debounced touch event
+         */
+        struct Event {
+            Direction direction;
+            Gesture gesture;
+        };
+
+        /**
+         * Nav pad struct containing the direction, the touchpad and its touch state
          */
         struct Pad {
             const Direction direction;
             std::unique_ptr<Touchpad> touchpad;
+            // set by the touch ISR
+            volatile TickType_t lastTouch{0}; // the tick the touch ISR fired last for this pad
+            volatile TickType_t pressTick{0};
+            volatile bool pressed{false};
+            volatile bool doubleTapped{false}; // the current touch is the second tap of a double tap
+            // set by the touch task
+            volatile TickType_t releaseTick{0};
+            volatile bool tapped{false}; // the last touch was a short tap, so the next press may be a double tap
+            bool longPressed{false};
+            TickType_t nextRepeat{0};
+            TickType_t repeatInterval{0};
+
+            // the persisted calibration; internal state, which does not change the version of the settings
+            Uint16Bean baseline;
+            Uint16Bean threshold;
 
-            Pad(Direction dir, uint8_t pin) : direction{dir}, touchpad{new Touchpad{pin}} {}
+            Pad(Direction dir, uint8_t pin, const char *baselineKey, const char *thresholdKey)
+                    : direction{dir}, touchpad{new Touchpad{pin}},
+                      baseline{baselineKey, AC.preferences, false}, threshold{thresholdKey, AC.preferences, false} {}
+
+            /**
+             * Persists the calibration of the touchpad if its baseline drifted from the persisted one
+             * @param drift The relative drift required to persist the calibration; 0 to persist any change
+             */
+            void persist(float drift = 0) {
+                auto current = touchpad->getBaseline();
+                auto stored = (uint16_t) baseline;
+                if (abs((int) current - (int) stored) <= stored * drift && current != 0 && stored != 0) return;
+                baseline = current;
+                threshold = touchpad->getThreshold();
+            }
         };
 
         /**
          * The nav pads
          */
-        const std::array<Pad, 5> navPads{
-                Pad{Direction::Center, TOUCHPAD_CENTER_PIN},
-                Pad{Direction::Left, TOUCHPAD_LEFT_PIN},
-                Pad{Direction::Right, TOUCHPAD_RIGHT_PIN},
-                Pad{Direction::Up, TOUCHPAD_UP_PIN},
-                Pad{Direction::Down, TOUCHPAD_DOWN_PIN}
+        std::array<Pad, 5> navPads{
+                Pad{Direction::Center, TOUCHPAD_CENTER_PIN, "tpCenterBase", "tpCenterThr"},
+                Pad{Direction::Left, TOUCHPAD_LEFT_PIN, "tpLeftBase", "tpLeftThr"},
+                Pad{Direction::Right, TOUCHPAD_RIGHT_PIN, "tpRightBase", "tpRightThr"},
+                Pad{Direction::Up, TOUCHPAD_UP_PIN, "tpUpBase", "tpUpThr"},
+                Pad{Direction::Down, TOUCHPAD_DOWN_PIN, "tpDownBase", "tpDownThr"}
         };
 
+        QueueHandle_t eventQueue{nullptr};
+        TaskHandle_t touchTask{nullptr};
+        portMUX_TYPE padsMux = portMUX_INITIALIZER_UNLOCKED;
 
         /**
-         * Sets up the navigation touch pads
+         * Posts a touch event to the event queue and wakes up the main loop
+         * @param direction The direction of the event
+         * @param gesture The gesture of the event
          */
-        void setup() { for (const auto &navPad: navPads) navPad.touchpad->setup(); }
+        void post(Direction direction, Gesture gesture) {
+            Event event{direction, gesture};
+            xQueueSend(eventQueue, &event, 0);
+            scheduler::notify(scheduler::TOUCH);
+        }
 
         /**
-         * Reads the navigation touch pads and returns the first direction that was touched\n
-         * To ensure proper functionality, this function should be called in every loop iteration.
-         * Returns the direction only once after initial touch.
-         * @return The direction that was touched or Direction::None if no direction was touched
+         * Touch ISR; fires repeatedly while a pad is touched\n
+         * Only the first interrupt of a touch posts a press or double tap event,
+         * all other gestures are detected by the touch task.
+         * @param arg The touched nav pad
          */
-        Direction read() {
-            static bool touched{false};
-            Direction dir{Direction::None};
-
-            for (const auto &navPad: navPads) {
-                if (navPad.touchpad->isTouched()) {
-                    dir = navPad.direction;
-                    break;
-                }
+        void IRAM_ATTR onTouch(void *arg) {
+            auto *pad = static_cast<Pad *>(arg);
+            BaseType_t higherPriorityTaskWoken = pdFALSE;
+            auto now = xTaskGetTickCountFromISR();
+            portENTER_CRITICAL_ISR(&padsMux);
+            pad->lastTouch = now;
+            bool pressed = !pad->pressed;
+            if (pressed) {
+                pad->pressed = true;
+                pad->pressTick = now;
+            }
+            portEXIT_CRITICAL_ISR(&padsMux);
+            if (pressed) {
+                bool doubleTap = pad->tapped && now - pad->releaseTick <= pdMS_TO_TICKS(config.doubleTapTime);
+                pad->doubleTapped = doubleTap;
+                Event event{pad->direction, doubleTap ? DOUBLE_TAP : PRESS};
+                xQueueSendFromISR(eventQueue, &event, &higherPriorityTaskWoken);
+                // the touch task is started after the pads are set up
+                if (touchTask != nullptr) vTaskNotifyGiveFromISR(touchTask, &higherPriorityTaskWoken);
+                scheduler::notifyFromISR(scheduler::TOUCH);
+            }
+            if (higherPriorityTaskWoken) portYIELD_FROM_ISR();
+        }
+
+        /**
+         * Detects the release, long press and repeats of a pad
+         * @param pad The pad
+         * @param now The current tick
+         * @return The ticks until the pad needs to be checked again or portMAX_DELAY if it is not pressed
+         */
+        TickType_t updatePad(Pad &pad, TickType_t now) {
+            const auto releaseTicks = pdMS_TO_TICKS(TOUCH_RELEASE_TIMEOUT);
+            const auto longPressTicks = pdMS_TO_TICKS(config.longPressTime);
+
+            portENTER_CRITICAL(&padsMux);
+            bool pressed = pad.pressed;
+            auto sinceTouch = now - pad.lastTouch;
+            auto held = now - pad.pressTick;
+            bool released = pressed && sinceTouch >= releaseTicks;
+            if (released) pad.pressed = false;
+            portEXIT_CRITICAL(&padsMux);
+
+            if (released) {
+                // double taps cannot be chained, and a long touch is no tap
+                pad.tapped = !pad.doubleTapped && !pad.longPressed;
+                pad.releaseTick = now;
+                pad.longPressed = false;
+                pad.repeatInterval = 0;
+                post(pad.direction, RELEASE);
+                return portMAX_DELAY;
             }
+            if (!pressed) return portMAX_DELAY;
 
-            if (!touched && dir != Direction::None) {
-                touched = true;
-                return dir;
+            if (pad.repeatInterval == 0) {
+                // first check of a new press
+                pad.repeatInterval = pdMS_TO_TICKS(config.repeatInterval);
+                pad.nextRepeat = pad.pressTick + pdMS_TO_TICKS(config.repeatDelay);
+            }
+            if (!pad.longPressed && held >= longPressTicks) {
+                pad.longPressed = true;
+                post(pad.direction, LONG_PRESS);
+            }
+            bool repeats = config.repeatDirections & 1 << (uint8_t) pad.direction;
+            if (repeats && (int32_t) (now - pad.nextRepeat) >= 0) {
+                post(pad.direction, REPEAT);
+                pad.nextRepeat = now + pad.repeatInterval;
+                pad.repeatInterval = max(pdMS_TO_TICKS(config.minRepeatInterval),
+                                         (TickType_t) ((float) pad.repeatInterval * config.repeatAcceleration));
             }
-            if (touched && dir == Direction::None) {
-                touched = false;
+
+            TickType_t wait = releaseTicks - sinceTouch;
+            if (!pad.longPressed) wait = min(wait, longPressTicks - held);
+            if (repeats) wait = min(wait, pad.nextRepeat - now);
+            return wait;
+        }
+
+        /**
+         * Touch task detecting all gestures of pressed pads apart from the initial press\n
+         * While no pad is pressed, the thresholds are adjusted to slow drifts of the pads' values
+         * and the calibration is persisted regularly if it drifted noticeably.
+         */
+        [[noreturn]] void touchTaskLoop(void *) {
+            TickType_t wait = pdMS_TO_TICKS(TOUCH_TRACK_INTERVAL);
+            TickType_t lastPersist = xTaskGetTickCount();
+            for (;;) {
+                bool notified = ulTaskNotifyTake(pdTRUE, max(wait, (TickType_t) 1)) > 0;
+                auto now = xTaskGetTickCount();
+                wait = portMAX_DELAY;
+                for (auto &navPad: navPads) wait = min(wait, updatePad(navPad, now));
+                if (wait != portMAX_DELAY) continue;
+
+                wait = pdMS_TO_TICKS(TOUCH_TRACK_INTERVAL);
+                if (notified) continue;
+                for (const auto &navPad: navPads) navPad.touchpad->track();
+                if (now - lastPersist >= pdMS_TO_TICKS(TOUCH_PERSIST_INTERVAL)) {
+                    lastPersist = now;
+                    for (auto &navPad: navPads) navPad.persist(TOUCH_PERSIST_DRIFT);
+                }
             }
+        }
 
+        /**
+         * Sets up the navigation touch pads using their persisted calibration and starts scanning them in hardware
+         */
+        void setup() {
+            eventQueue = xQueueCreate(TOUCH_EVENT_QUEUE_SIZE, sizeof(Event));
+            assert(eventQueue != nullptr && "Could not create touch event queue");
+            for (auto &navPad: navPads) {
+                navPad.baseline.load();
+                navPad.threshold.load();
+                navPad.touchpad->setup(onTouch, &navPad, (uint16_t) navPad.baseline, (uint16_t) navPad.threshold);
+                navPad.persist();
+            }
+            auto result = xTaskCreate(touchTaskLoop, "touch", 2048, nullptr, 2, &touchTask);
+            assert(result == pdPASS && "Could not create touch task");
+        }
+
+        /**
+         * Takes the next touch event from the event queue without blocking
+         * @param event The event to write to
+         * @return True if an event was taken, false if the queue is empty
+         */
+        bool nextEvent(Event &event) { return xQueueReceive(eventQueue, &event, 0) == pdTRUE; }
+
+        /**
+         * Consumes the pending touch events and returns the direction of the first event with one of the given gestures\n
+         * Double taps are reported as presses if they are not opted into.
+         * Each event is returned only once, so calling this function multiple times per loop iteration is harmless.
+         * @param gestures The gestures to report as mask; events with other gestures are dropped
+         * @param gesture If not null, the reported gesture is written to it
+         * @return The direction of the event or Direction::None if no matching event was pending
+         */
+        Direction read(uint8_t gestures = PRESS, Gesture *gesture = nullptr) {
+            Event event{};
+            while (nextEvent(event)) {
+                if (event.gesture == DOUBLE_TAP && !(gestures & DOUBLE_TAP)) event.gesture = PRESS;
+                if (gestures & event.gesture) {
+                    if (gesture) *gesture = event.gesture;
+                    return event.direction;
+                }
+            }
             return Direction::None;
         }
 
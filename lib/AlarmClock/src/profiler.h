@@ -0,0 +1,233 @@
+#ifndef ALARM_CLOCK_PROFILER_H
+#define ALARM_CLOCK_PROFILER_H
+
+
+namespace AlarmClock {
+    namespace profiler {
+
+        /**
+         * The stages of the main loop that are profiled
+         */
+        enum class Stage : uint8_t {
+            Alarms,
+            Matrix,
+            Navigation,
+            UI,
+            LightSensor,
+            COUNT
+        };
+
+        /**
+         * Returns the name of the given stage as used in the metrics JSON
+         * @param stage The stage
+         * @return The name of the stage
+         */
+        const char *stageName(Stage stage) {
+            switch (stage) {
+                case Stage::Alarms:
+                    return "handleAlarms";
+                case Stage::Matrix:
+                    return "matrix.loop";
+                case Stage::Navigation:
+                    return "navigation::read";
+                case Stage::UI:
+                    return "UIDisplay::loop";
+                case Stage::LightSensor:
+                    return "lightSensor.tryReading";
+                default:
+                    return "unknown";
+            }
+        }
+
+        /**
+         * A histogram of stage durations with logarithmic buckets\n
+         * Bucket 0 counts durations below 1 µs, bucket i counts durations in [2^(i-1), 2^i) µs
+         * and the last bucket counts all durations above that.
+         */
+        struct Histogram {
+            static constexpr uint8_t BUCKETS = 20;
+
+            std::array<uint32_t, BUCKETS> buckets{};
+            uint32_t count{0};
+            uint64_t totalCycles{0};
+            uint64_t maxCycles{0};
+            uint32_t worstUptime{0}; // ms
+            uint32_t worstDateTime{0}; // unix time
+
+            /**
+             * Records a measured duration
+             * @param cycles The duration in CPU cycles
+             * @param uptime The uptime at the end of the measurement in ms
+             * @return true if the duration is the longest one, false otherwise
+             */
+            bool record(uint64_t cycles, uint32_t uptime) {
+                auto us = cycles / ESP.getCpuFreqMHz();
+                uint8_t bucket = us == 0 ? 0 : (uint8_t) (64 - __builtin_clzll(us));
+                buckets[min(bucket, (uint8_t) (BUCKETS - 1))]++;
+                count++;
+                totalCycles += cycles;
+                if (cycles <= maxCycles) return false;
+                maxCycles = cycles;
+                worstUptime = uptime;
+                return true;
+            }
+
+            /**
+             * Estimates the given percentile as the upper bound of the bucket it falls into
+             * @param percentile The percentile to estimate (0-100)
+             * @return The estimated percentile in µs, at most the maximum duration
+             */
+            uint32_t percentile(uint8_t percentile) const {
+                auto maxUs = (uint32_t) min(maxCycles / ESP.getCpuFreqMHz(), (uint64_t) UINT32_MAX);
+                auto target = (uint32_t) (((uint64_t) count * percentile + 99) / 100);
+                uint32_t cumulative{0};
+                for (uint8_t i = 0; i < BUCKETS; ++i) {
+                    cumulative += buckets[i];
+                    // the last bucket is open-ended, so its upper bound is the maximum
+                    if (cumulative >= target) return i == BUCKETS - 1 ? maxUs : min((uint32_t) 1 << i, maxUs);
+                }
+                return maxUs;
+            }
+
+            /**
+             * Creates JSON data from the histogram
+             * @param json The JSON object to create the JSON data in
+             */
+            void toJson(const JsonVariant &json) const {
+                auto mhz = ESP.getCpuFreqMHz();
+                json["count"] = count;
+                json["meanUs"] = count ? (uint32_t) (totalCycles / count / mhz) : 0;
+                json["p99Us"] = percentile(99);
+                json["maxUs"] = (uint64_t) (maxCycles / mhz);
+                json["maxCycles"] = maxCycles;
+                json["worstUptime"] = worstUptime;
+                json["worstDateTime"] = worstDateTime;
+                auto bucketsJson = json.createNestedArray("buckets");
+                for (auto bucket: buckets) bucketsJson.add(bucket);
+            }
+        };
+
+        /**
+         * A histogram that is recorded by one task and read by others, e.g. the web server\n
+         * The histogram is only accessed in a critical section, so a reader gets a consistent snapshot.
+         * A reset is only requested by the readers and carried out by the writer with its next record.
+         */
+        class SharedHistogram {
+
+            Histogram histogram{};
+            mutable portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+            std::atomic<bool> resetRequested{false};
+
+        public:
+            SharedHistogram() = default;
+
+            /**
+             * Records a measured duration
+             * @param cycles The duration in CPU cycles
+             */
+            void record(uint64_t cycles) {
+                auto uptime = millis();
+                portENTER_CRITICAL(&mux);
+                if (resetRequested.exchange(false)) histogram = Histogram{};
+                auto worst = histogram.record(cycles, uptime);
+                portEXIT_CRITICAL(&mux);
+                if (worst) {
+                    // the time is read outside the critical section, as the seqlock may have to wait for a writer
+                    auto dateTime = AC.now.load().unixtime();
+                    portENTER_CRITICAL(&mux);
+                    if (histogram.maxCycles == cycles) histogram.worstDateTime = dateTime;
+                    portEXIT_CRITICAL(&mux);
+                }
+            }
+
+            /**
+             * @return A consistent copy of the histogram; empty if a reset is pending
+             */
+            Histogram snapshot() const {
+                if (resetRequested) return Histogram{};
+                portENTER_CRITICAL(&mux);
+                auto copy = histogram;
+                portEXIT_CRITICAL(&mux);
+                return copy;
+            }
+
+            /**
+             * Requests to clear the histogram with the next record
+             */
+            void reset() { resetRequested = true; }
+
+            // delete copy constructor and assignment operator
+
+            SharedHistogram(const SharedHistogram &) = delete;
+
+            SharedHistogram &operator=(const SharedHistogram &) = delete;
+
+        };
+
+        std::array<SharedHistogram, (size_t) Stage::COUNT> histograms{};
+
+        /**
+         * The latency between the RTC alarm interrupt and the player's acknowledgement of the alarm sound,
+         * i.e. the start of the sound
+         */
+        SharedHistogram alarmLatency{};
+
+        /**
+         * A probe measuring the CPU cycles from its construction until its destruction
+         */
+        class Probe {
+
+            const Stage stage;
+            const uint32_t start;
+
+        public:
+
+            explicit Probe(Stage stage) : stage(stage), start(ESP.getCycleCount()) {}
+
+            ~Probe() { histograms[(size_t) stage].record(ESP.getCycleCount() - start); }
+
+            // delete copy constructor and assignment operator
+
+            Probe(const Probe &) = delete;
+
+            Probe &operator=(const Probe &) = delete;
+
+        };
+
+        /**
+         * Runs the given function and records its duration for the given stage
+         * @tparam F The function type
+         * @param stage The stage to record the duration for
+         * @param f The function to run
+         * @return The return value of the function
+         */
+        template<typename F>
+        auto measure(Stage stage, F f) -> decltype(f()) {
+            Probe probe{stage};
+            return f();
+        }
+
+        /**
+         * Requests to reset all histograms; each one is cleared with its next record
+         */
+        void reset() { for (auto &histogram: histograms) histogram.reset(); }
+
+        /**
+         * Creates JSON data from all histograms
+         * @param json The JSON object to create the JSON data in
+         */
+        void toJson(const JsonVariant &json) {
+            json["cpuFreqMHz"] = ESP.getCpuFreqMHz();
+            auto bounds = json.createNestedArray("bucketBoundsUs");
+            for (uint8_t i = 0; i < Histogram::BUCKETS - 1; ++i) bounds.add((uint32_t) 1 << i);
+            auto stages = json.createNestedObject("stages");
+            for (size_t i = 0; i < histograms.size(); ++i) {
+                histograms[i].snapshot().toJson(stages.createNestedObject(stageName((Stage) i)));
+            }
+        }
+
+    }
+}
+
+
+#endif //ALARM_CLOCK_PROFILER_H
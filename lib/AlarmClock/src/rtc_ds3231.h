@@ -15,6 +15,7 @@ namespace AlarmClock {
          * @return True if the RTC was setup successfully, false otherwise
          */
         bool setup(RTC_DS3231 &rtc = AC.rtc) {
+            I2CBus::Transaction transaction{i2c::rtc};
             if (!rtc.begin()) return false;
             if (rtc.lostPower()) rtc.adjust(DateTime(F(__DATE__), F(__TIME__)));
             rtc.clearAlarm(1);
@@ -61,7 +62,11 @@ namespace AlarmClock {
                     static_cast<uint8_t>(t.tm_min),
                     static_cast<uint8_t>(t.tm_sec)
             };
-            if (dt.isValid() && abs((AC.now - dt).totalseconds()) > 10) AC.rtc.adjust(dt);
+            if (dt.isValid() && abs((AC.now.load() - dt).totalseconds()) > 10) {
+                I2CBus::Transaction transaction{i2c::rtc};
+                AC.rtc.adjust(dt);
+                timebase::sync(AC.rtc);
+            }
             return true;
         }
 
@@ -0,0 +1,65 @@
+#ifndef ALARM_CLOCK_SCHEDULER_H
+#define ALARM_CLOCK_SCHEDULER_H
+
+
+namespace AlarmClock {
+    namespace scheduler {
+
+        /**
+         * The events the main loop can be woken up by\n
+         * Each event is a bit of the scheduler's event group and stands for the subsystem that has work to do.
+         */
+        enum Event : EventBits_t {
+            ALARM_TRIGGERED = BIT0, // the alarm task started an alarm
+            TIME_TICK = BIT1, // the time base ticked, i.e. a new second started
+            LIGHT_SENSOR = BIT2, // a new light sensor reading is due
+            UI_UPDATE = BIT3, // the ui was changed from outside the main loop
+            WEB_COMMAND = BIT4, // a web request changed the alarm clock's state
+            TOUCH = BIT5, // a touchpad was pressed or released
+            SOUND_CATALOG = BIT6, // the player counted the files on its SD card
+            UI_TIMEOUT = BIT7, // the ui was not used for a while, so it returns to the home frame
+            ALL_EVENTS = ALARM_TRIGGERED | TIME_TICK | LIGHT_SENSOR | UI_UPDATE | WEB_COMMAND | TOUCH | SOUND_CATALOG |
+                         UI_TIMEOUT
+        };
+
+        EventGroupHandle_t eventGroup{nullptr};
+
+        /**
+         * Creates the event group; must be called before any event is posted
+         */
+        void setup() {
+            eventGroup = xEventGroupCreate();
+            assert(eventGroup != nullptr && "Could not create scheduler event group");
+        }
+
+        /**
+         * Posts the given events, waking up the main loop
+         * @param events The events to post
+         */
+        void notify(EventBits_t events) { xEventGroupSetBits(eventGroup, events); }
+
+        /**
+         * Posts the given events from within an ISR, waking up the main loop
+         * @param events The events to post
+         */
+        void IRAM_ATTR notifyFromISR(EventBits_t events) {
+            BaseType_t higherPriorityTaskWoken = pdFALSE;
+            xEventGroupSetBitsFromISR(eventGroup, events, &higherPriorityTaskWoken);
+            if (higherPriorityTaskWoken) portYIELD_FROM_ISR();
+        }
+
+        /**
+         * Blocks the calling task until any event is posted or the timeout expired; clears the returned events
+         * @param timeout The maximum time to wait in milliseconds; UINT32_MAX to wait without a timeout
+         * @return The events that were posted or 0 if the timeout expired
+         */
+        EventBits_t wait(uint32_t timeout) {
+            auto ticks = timeout >= portMAX_DELAY / configTICK_RATE_HZ ? portMAX_DELAY : pdMS_TO_TICKS(timeout);
+            return xEventGroupWaitBits(eventGroup, ALL_EVENTS, pdTRUE, pdFALSE, ticks);
+        }
+
+    }
+}
+
+
+#endif //ALARM_CLOCK_SCHEDULER_H
@@ -0,0 +1,139 @@
+#ifndef ALARM_CLOCK_TIMEBASE_H
+#define ALARM_CLOCK_TIMEBASE_H
+
+
+namespace AlarmClock {
+    namespace timebase {
+
+        /**
+         * The current time in seconds since 1970; incremented by the RTC's 1 Hz square wave
+         */
+        volatile uint32_t seconds{0};
+        volatile int64_t tickTime{0}; // µs since boot of the last tick
+        volatile uint32_t lastSync{0}; // the time of the last sync with the RTC
+        volatile bool suspended{false};
+        /**
+         * Whether the alarms need to be polled on every tick instead of only on full minutes,
+         * e.g. because a snoozed alarm may go off at any second
+         */
+        volatile bool pollEverySecond{false};
+        void (*onAlarmTick)(){nullptr};
+        portMUX_TYPE timeMux = portMUX_INITIALIZER_UNLOCKED;
+
+        /**
+         * The ISR attached to the RTC's SQW pin; the seconds register of the DS3231 is incremented on the falling edge\n
+         * Advances the time and wakes up the main loop; on full minutes or if requested on every tick,
+         * the alarm callback is called to poll the RTC's alarm flags on the same edge.
+         */
+        void IRAM_ATTR onTick() {
+            if (suspended) return;
+            portENTER_CRITICAL_ISR(&timeMux);
+            auto t = seconds + 1;
+            seconds = t;
+            tickTime = esp_timer_get_time();
+            portEXIT_CRITICAL_ISR(&timeMux);
+            if (t % 60 == 0 || pollEverySecond) onAlarmTick();
+            scheduler::notifyFromISR(scheduler::TIME_TICK);
+        }
+
+        /**
+         * Reads the time from the RTC and sets the time kept in RAM to it\n
+         * If a tick occurs while the RTC is read, the read time may be from before the tick,
+         * so the RTC is read again instead of losing the tick.
+         * @param rtc The DS3231 RTC
+         * @return True if the read time was valid, false otherwise
+         */
+        bool sync(RTC_DS3231 &rtc) {
+            I2CBus::Transaction transaction{i2c::rtc};
+            for (;;) {
+                int64_t before = tickTime;
+                auto dt = rtc.now();
+                if (!dt.isValid()) return false;
+                portENTER_CRITICAL(&timeMux);
+                bool ticked = tickTime != before;
+                if (!ticked) {
+                    seconds = dt.unixtime();
+                    lastSync = seconds;
+                }
+                portEXIT_CRITICAL(&timeMux);
+                if (!ticked) return true;
+            }
+        }
+
+        /**
+         * Verifies the time kept in RAM against the RTC if the last sync is longer ago than the verify interval
+         * @param rtc The DS3231 RTC
+         */
+        void verify(RTC_DS3231 &rtc) {
+            if (seconds - lastSync >= TIME_VERIFY_INTERVAL) sync(rtc);
+        }
+
+        /**
+         * Sets up the time base; switches the RTC's SQW pin to a 1 Hz square wave and attaches the tick ISR
+         * @param rtc The DS3231 RTC
+         * @param pin The pin the RTC's SQW pin is connected to
+         * @param alarmTick The ISR to call on ticks the RTC's alarm flags should be polled on; must reside in IRAM
+         */
+        void setup(RTC_DS3231 &rtc, uint8_t pin, void (*alarmTick)()) {
+            onAlarmTick = alarmTick;
+            {
+                I2CBus::Transaction transaction{i2c::rtc};
+                rtc.writeSqwPinMode(DS3231_SquareWave1Hz);
+                sync(rtc);
+            }
+            pinMode(pin, INPUT_PULLUP);
+            ::attachInterrupt(digitalPinToInterrupt(pin), onTick, FALLING);
+        }
+
+        /**
+         * @return The current time as kept in RAM
+         */
+        DateTime now() { return DateTime{seconds}; }
+
+        /**
+         * @return The milliseconds passed since the current second started, interpolated using the ESP32's timer
+         */
+        uint16_t millisOfSecond() {
+            portENTER_CRITICAL(&timeMux);
+            auto since = esp_timer_get_time() - tickTime;
+            portEXIT_CRITICAL(&timeMux);
+            return (uint16_t) min(since / 1000, (int64_t) 999);
+        }
+
+        /**
+         * Guard enabling the RTC's alarm output for its lifetime, which is needed to set the RTC's alarms\n
+         * The SQW pin outputs either the square wave or the alarm interrupt, so the ticks are suspended
+         * and the time is synced with the RTC again once the square wave is restored.
+         * The guard holds the RTC's I2C transaction for its lifetime.
+         */
+        class AlarmAccess {
+
+            I2CBus::Transaction transaction{i2c::rtc};
+            RTC_DS3231 &rtc;
+
+        public:
+
+            explicit AlarmAccess(RTC_DS3231 &rtc) : rtc(rtc) {
+                suspended = true;
+                rtc.writeSqwPinMode(DS3231_OFF);
+            }
+
+            ~AlarmAccess() {
+                rtc.writeSqwPinMode(DS3231_SquareWave1Hz);
+                suspended = false; // resume first, so a tick during the sync is not lost
+                sync(rtc);
+            }
+
+            // delete copy constructor and assignment operator
+
+            AlarmAccess(const AlarmAccess &) = delete;
+
+            AlarmAccess &operator=(const AlarmAccess &) = delete;
+
+        };
+
+    }
+}
+
+
+#endif //ALARM_CLOCK_TIMEBASE_H
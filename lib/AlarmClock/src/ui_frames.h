@@ -56,11 +56,12 @@ namespace AlarmClock {
     }
 
     void overview(UIGraphics ui) {
+        auto now = AC.now.load();
         String buf("DDD, DD. MMM 'YY");
-        AC.now.toString(buf.begin());
+        now.toString(buf.begin());
         ui.drawLine(UserInterface::Line::L1, buf, TEXT_ALIGN_CENTER);
-        auto a1dt = getAlarmTime(AC.alarm1, AC.now);
-        auto a2dt = getAlarmTime(AC.alarm2, AC.now);
+        auto a1dt = getAlarmTime(AC.alarm1, now);
+        auto a2dt = getAlarmTime(AC.alarm2, now);
         DateTime nil{};
         auto next = 0;
         if (a1dt != nil) {
@@ -68,7 +69,7 @@ namespace AlarmClock {
             else next = 1;
         } else if (a2dt != nil) next = 2;
         if (next != 0) {
-            auto ts = (next == 1 ? a1dt : a2dt) - AC.now;
+            auto ts = (next == 1 ? a1dt : a2dt) - now;
             sprintf(buf.begin(), "A%u in %ud %uh %um %us", next, ts.days(), ts.hours(), ts.minutes(), ts.seconds());
             ui.drawLine(UserInterface::Line::L2, buf);
         } else ui.drawLine(UserInterface::Line::L2, "no alarm set");
@@ -128,12 +129,11 @@ namespace AlarmClock {
     void alarmSound(UIGraphics ui) {
         auto title = AC.alarmToSet == N::ONE ? "Set Alarm 1 Sound" : "Set Alarm 2 Sound";
         ui.drawTitle(title);
-        auto soundID = (uint8_t) (AC.alarmToSet == N::ONE ? AC.alarm1.sound : AC.alarm2.sound);
+        auto soundID = (uint16_t) (AC.alarmToSet == N::ONE ? AC.alarm1.sound : AC.alarm2.sound);
         ui.drawSetter(UserInterface::Line::L2, "Sound #", soundID);
-        if (soundID) {
-            auto &sound = *Sound::getSoundById(soundID, AC.sounds);
-            ui.drawLine(UserInterface::Line::L3, sound.getName());
-        } else ui.drawLine(UserInterface::Line::L3, "~ random sound");
+        if (AC.sounds.contains(soundID)) {
+            ui.drawLine(UserInterface::Line::L3, AC.sounds.getName(soundID));
+        } else if (soundID == 0) ui.drawLine(UserInterface::Line::L3, "~ random sound");
         ui.drawLine(UserInterface::Line::L5, "Press MID t0 preview", TEXT_ALIGN_CENTER);
     }
 
@@ -155,18 +155,21 @@ namespace AlarmClock {
 
     void playerPlay(UIGraphics ui) {
         ui.drawTitle("Play Sound");
-        ui.drawSetter(UserInterface::Line::L2, "Sound #", ui.cursor());
-        if (ui.cursor()) {
-            auto &sound = *Sound::getSoundById(ui.cursor(), AC.sounds);
-            ui.drawLine(UserInterface::Line::L3, sound.getName());
-        } else ui.drawLine(UserInterface::Line::L3, "~ random sound");
+        ui.drawSetter(UserInterface::Line::L2, "Sound #", AC.soundToSet);
+        if (AC.sounds.contains(AC.soundToSet)) {
+            ui.drawLine(UserInterface::Line::L3, AC.sounds.getName(AC.soundToSet));
+        } else if (AC.soundToSet == 0) ui.drawLine(UserInterface::Line::L3, "~ random sound");
     }
 
     void playerSounds(UIGraphics ui) {
         ui.drawTitle("Set sound random play");
-        ui.drawSetter(UserInterface::Line::L2, "Sound #", ui.cursor() + 1);
-        auto &sound = *Sound::getSoundById(ui.cursor() + 1, AC.sounds);
-        ui.drawLine(UserInterface::Line::L3, sound.getName());
+        ui.drawSetter(UserInterface::Line::L2, "Sound #", AC.soundToSet);
+        Sound sound{};
+        if (!AC.sounds.find(AC.soundToSet, sound)) {
+            ui.drawLine(UserInterface::Line::L3, "~ no sounds found");
+            return;
+        }
+        ui.drawLine(UserInterface::Line::L3, AC.sounds.getName(sound.getId()));
         ui.drawLine(UserInterface::Line::L4, sound.isAllowRandom() ? "random = true" : "random = false");
     }
 
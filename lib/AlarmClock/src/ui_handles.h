@@ -8,15 +8,40 @@
 
 namespace AlarmClock {
 
-    navigation::Direction getInput() {
-        auto direction = navigation::read();
-        if (direction != navigation::Direction::None
-            && AC.alarm1.state != AlarmState::PLAYING
-            && AC.alarm2.state != AlarmState::PLAYING)
-            AC.uiTimer.reset();
+    /**
+     * Reads the navigation input and keeps the ui awake if there was any
+     * @param gestures The gestures the calling ui handle opts into as mask, see navigation::read
+     * @param gesture If not null, the reported gesture is written to it
+     * @return The direction of the input or Direction::None if there was no input
+     */
+    navigation::Direction getInput(uint8_t gestures = navigation::PRESS, navigation::Gesture *gesture = nullptr) {
+        auto direction = navigation::read(gestures, gesture);
+        if (direction != navigation::Direction::None) {
+            AC.ui.wake();
+            if (AC.alarm1.state != AlarmState::PLAYING && AC.alarm2.state != AlarmState::PLAYING)
+                AC.uiTimer.reset();
+        }
         return direction;
     }
 
+    /**
+     * Returns the number of sounds an up or down input steps in the sound frames
+     * @param gesture The gesture of the input
+     * @return SOUND_DOUBLE_TAP_STEPS for a double tap, as the tap before it already stepped once, 1 otherwise
+     */
+    int soundSteps(navigation::Gesture gesture) {
+        return gesture == navigation::DOUBLE_TAP ? SOUND_DOUBLE_TAP_STEPS - 1 : 1;
+    }
+
+    /**
+     * Plays the sound with the given id as preview
+     * @param id The id of the sound; 0 for a random sound
+     */
+    void playSound(uint16_t id) {
+        Sound sound{};
+        if (id == 0 ? AC.sounds.findRandom(sound) : AC.sounds.find(id, sound)) AC.player.play(sound);
+    }
+
     // ui handle for the home frame
     void uiHome(UIDisplay &ui) {
         static const ESP32_Timer matrixScrollTimer{
@@ -225,6 +250,7 @@ namespace AlarmClock {
 
     // ui handle for the alarm menu frame
     void uiAlarmMenu(UIDisplay &ui) {
+        AlarmLock lock{}; // the alarm task and the turn off timer change the alarms as well
         auto cursor = ui.getCursor();
         auto &alarm = AC.alarmToSet == N::ONE ? AC.alarm1 : AC.alarm2;
         switch (getInput()) {
@@ -233,7 +259,7 @@ namespace AlarmClock {
                     alarm.toggle = !alarm.toggle;
                     break;
                 } else if (cursor == 2) {
-                    setIn8hFromNow(alarm, AC.now);
+                    setIn8hFromNow(alarm, AC.now.load());
                     break;
                 }
                 [[fallthrough]]; // else fall through
@@ -248,7 +274,7 @@ namespace AlarmClock {
                         ui.transitionToFrame(0); // home frame
                         break;
                     case 2:
-                        setIn8hFromNow(alarm, AC.now);
+                        setIn8hFromNow(alarm, AC.now.load());
                         ui.transitionToFrame(0); // home frame
                         break;
                     case 3:
@@ -275,25 +301,39 @@ namespace AlarmClock {
 
     // ui handle for the alarm time frame
     void uiAlarmTime(UIDisplay &ui) {
+        AlarmLock lock{};
         /*
          * cursor 0: hour tens
          * cursor 1: hour ones
          * cursor 2: minute tens
          * cursor 3: minute ones
          * cursor 4-10: repeat
+         * center moves to the next field and a long press of it confirms the alarm,
+         * a double tap of left goes back to the alarm menu from any field
          */
         auto cursor = ui.getCursor();
         auto &alarm = AC.alarmToSet == N::ONE ? AC.alarm1 : AC.alarm2;
         auto h = (uint8_t) alarm.hour;
         auto m = (uint8_t) alarm.minute;
         auto r = (uint8_t) alarm.repeat;
-        switch (getInput()) {
+        navigation::Gesture gesture{};
+        auto direction = getInput(
+                navigation::PRESS | navigation::REPEAT | navigation::LONG_PRESS | navigation::DOUBLE_TAP, &gesture);
+        // only a long press of center confirms, the other pads were already handled by their press
+        if (gesture == navigation::LONG_PRESS && direction != navigation::Direction::Center) {
+            direction = navigation::Direction::None;
+        }
+        switch (direction) {
             case navigation::Direction::Left:
-                if (cursor == 0) ui.transitionToFrame(6); // alarm menu frame
+                if (cursor == 0 || gesture == navigation::DOUBLE_TAP) ui.transitionToFrame(6); // alarm menu frame
                 else ui.setCursor(cursor - 1);
                 break;
             case navigation::Direction::Center:
-                ui.transitionToFrame(0); // home frame
+                if (gesture == navigation::LONG_PRESS) {
+                    alarm.toggle = true;
+                    setAlarm(alarm, AC.rtc);
+                    ui.transitionToFrame(0); // home frame
+                } else ui.setCursor((cursor + 1) % 11);
                 break;
             case navigation::Direction::Right:
                 if (cursor == 10) ui.transitionToFrame(0); // home frame
@@ -346,15 +386,15 @@ namespace AlarmClock {
         }
     }
 
-    // ui handle for the alarm sound frame
+    // ui handle for the alarm sound frame; a double tap of up or down steps SOUND_DOUBLE_TAP_STEPS sounds
     void uiAlarmSound(UIDisplay &ui) {
-        auto numSounds = AC.sounds.size();
+        AlarmLock lock{};
         auto &alarm = (AC.alarmToSet == N::ONE ? AC.alarm1 : AC.alarm2);
-        auto sound = (uint8_t) alarm.sound;
-        switch (getInput()) {
+        auto sound = (uint16_t) alarm.sound;
+        navigation::Gesture gesture{};
+        switch (getInput(navigation::PRESS | navigation::REPEAT | navigation::DOUBLE_TAP, &gesture)) {
             case navigation::Direction::Center:
-                if (sound) AC.player.play(sound);
-                else AC.player.play((uint8_t) random((long) numSounds));
+                playSound(sound);
                 break;
             case navigation::Direction::Left:
                 ui.transitionToFrame(6); // alarm menu frame
@@ -364,10 +404,10 @@ namespace AlarmClock {
                 ui.transitionToFrame(0); // home frame
                 break;
             case navigation::Direction::Up:
-                alarm.sound = (sound + 1) % (numSounds);
+                alarm.sound = AC.sounds.step(sound, soundSteps(gesture), true);
                 break;
             case navigation::Direction::Down:
-                alarm.sound = (uint8_t) ((sound + numSounds - 1) % (numSounds));
+                alarm.sound = AC.sounds.step(sound, -soundSteps(gesture), true);
                 break;
             case navigation::Direction::None:
                 break;
@@ -390,6 +430,7 @@ namespace AlarmClock {
                         ui.transitionToFrame(10); // player volume frame
                         break;
                     case 1:
+                        AC.soundToSet = 0;
                         ui.transitionToFrame(11); // player play frame
                         break;
                     case 2:
@@ -397,6 +438,7 @@ namespace AlarmClock {
                         ui.transitionToFrame(0); // home frame
                         break;
                     case 3:
+                        AC.soundToSet = AC.sounds.step(0, 0, false);
                         ui.transitionToFrame(12); // player sounds frame
                         break;
                     default:
@@ -420,7 +462,7 @@ namespace AlarmClock {
 
     // ui handle for the player volume frame
     void uiPlayerVolume(UIDisplay &ui) {
-        switch (getInput()) {
+        switch (getInput(navigation::PRESS | navigation::REPEAT)) {
             case navigation::Direction::Center:
             case navigation::Direction::Right:
                 ui.transitionToFrame(0); // home frame
@@ -439,14 +481,12 @@ namespace AlarmClock {
         }
     }
 
-    // ui handle for the player play frame
+    // ui handle for the player play frame; a double tap of up or down steps SOUND_DOUBLE_TAP_STEPS sounds
     void uiPlayerPlay(UIDisplay &ui) {
-        auto cursor = ui.getCursor();
-        auto numSounds = AC.sounds.size();
-        switch (getInput()) {
+        navigation::Gesture gesture{};
+        switch (getInput(navigation::PRESS | navigation::REPEAT | navigation::DOUBLE_TAP, &gesture)) {
             case navigation::Direction::Center:
-                if (cursor) AC.player.play(cursor);
-                else AC.player.play((uint8_t) random((long) numSounds));
+                playSound(AC.soundToSet);
                 [[fallthrough]]; // fall through
             case navigation::Direction::Left:
                 ui.transitionToFrame(9); // player menu frame
@@ -456,27 +496,28 @@ namespace AlarmClock {
                 ui.transitionToFrame(0); // home frame
                 break;
             case navigation::Direction::Up:
-                ui.setCursor((cursor + 1) % (numSounds));
+                AC.soundToSet = AC.sounds.step(AC.soundToSet, soundSteps(gesture), true);
                 break;
             case navigation::Direction::Down:
-                ui.setCursor((uint8_t) ((cursor + numSounds - 1) % (numSounds)));
+                AC.soundToSet = AC.sounds.step(AC.soundToSet, -soundSteps(gesture), true);
                 break;
             case navigation::Direction::None:
                 break;
         }
     }
 
-    // ui handle for the player sounds frame
+    // ui handle for the player sounds frame; a double tap of up or down steps SOUND_DOUBLE_TAP_STEPS sounds
     void uiPlayerSounds(UIDisplay &ui) {
-        auto cursor = ui.getCursor();
-        auto numSounds = AC.sounds.size();
-        switch (getInput()) {
+        navigation::Gesture gesture{};
+        switch (getInput(navigation::PRESS | navigation::REPEAT | navigation::DOUBLE_TAP, &gesture)) {
             case navigation::Direction::Right:
                 ui.transitionToFrame(0); // home frame
                 [[fallthrough]]; // fall through
             case navigation::Direction::Center: {
-                auto sound = *Sound::getSoundById(cursor + 1, AC.sounds);
-                sound.setAllowRandom(!sound.isAllowRandom());
+                Sound sound{};
+                if (AC.sounds.find(AC.soundToSet, sound)) {
+                    AC.sounds.setAllowRandom(sound.getId(), !sound.isAllowRandom());
+                }
                 break;
             }
             case navigation::Direction::Left:
@@ -484,10 +525,10 @@ namespace AlarmClock {
                 ui.setCursor(3);
                 break;
             case navigation::Direction::Up:
-                ui.setCursor((cursor + 1) % (numSounds - 1));
+                AC.soundToSet = AC.sounds.step(AC.soundToSet, soundSteps(gesture), false);
                 break;
             case navigation::Direction::Down:
-                ui.setCursor((uint8_t) ((cursor + numSounds - 2) % (numSounds - 1)));
+                AC.soundToSet = AC.sounds.step(AC.soundToSet, -soundSteps(gesture), false);
                 break;
             case navigation::Direction::None:
                 break;
@@ -496,7 +537,7 @@ namespace AlarmClock {
 
     // ui handle for the light duration frame
     void uiLightDuration(UIDisplay &ui) {
-        switch (getInput()) {
+        switch (getInput(navigation::PRESS | navigation::REPEAT)) {
             case navigation::Direction::Center:
             case navigation::Direction::Right:
                 ui.transitionToFrame(0); // home frame
@@ -11,14 +11,27 @@ namespace AlarmClock {
 
         void setup(AsyncWebServer & = AC.server);
 
+        /**
+         * An event for the clients of the event source, queued by the main loop and sent by the network task
+         */
+        struct Event {
+            std::array<char, 16> name;
+            std::array<char, JSON_EVENT_BUF_SIZE> data;
+        };
+
+        AsyncEventSource eventSource{"/events"};
+        QueueHandle_t eventQueue{nullptr};
+        std::atomic<bool> eventResync{false}; // whether all state is pushed again, as a client connected
+        uint32_t bootNonce{0}; // random per boot, as the revisions the entity tags are built from restart at 0
+
         //#region general GET
 
         void getCurrentDateTime(AsyncWebServerRequest *request) {
-            auto *response = new AsyncJsonResponse();
-            auto root = response->getRoot();
-            root["value"] = AC.now.unixtime();
-            response->setLength();
-            request->send(response);
+            DocumentResponse response{request};
+            auto &root = response.getRoot();
+            root["value"] = AC.now.load().unixtime();
+            root["millis"] = timebase::millisOfSecond();
+            response.send();
         }
 
         void getOnTime(AsyncWebServerRequest *request) {
@@ -26,52 +39,151 @@ namespace AlarmClock {
         }
 
         void getLightSensor(AsyncWebServerRequest *request) {
-            auto *response = new AsyncJsonResponse();
-            auto root = response->getRoot();
+            DocumentResponse response{request};
+            auto &root = response.getRoot();
             root["value"] = AC.lightLevel;
-            response->setLength();
-            request->send(response);
+            response.send();
+        }
+
+        /**
+         * @brief Answers a request that submitted a command without waiting for it to be applied:
+         * 202 if it was queued and 503 if the command queue is full
+         * @param request The request
+         * @param queued Whether the command was queued
+         */
+        void reply(AsyncWebServerRequest *request, bool queued) {
+            if (queued) request->send(202);
+            else request->send(503, "text/plain", "Too many commands");
         }
 
         void play(AsyncWebServerRequest *request) {
             if (request->hasParam("sound")) {
-                auto sound = (uint8_t) request->getParam("sound")->value().toInt();
-                if (sound == 0) {
-                    auto rnd = (uint8_t) random(1, (long) AC.sounds.size() + 1);
-                    AC.player.play(rnd);
-                } else {
-                    auto itr = std::find_if(
-                            AC.sounds.begin(),
-                            AC.sounds.end(),
-                            [&sound](const Sound &s) { return s.getId() == sound; }
-                    );
-                    if (itr != AC.sounds.end()) {
-                        AC.player.play(sound);
-                    } else {
-                        request->send(404, "text/plain", "Sound not found");
-                        return;
-                    }
+                commands::Command command{commands::Type::Play};
+                command.sound.id = (uint16_t) request->getParam("sound")->value().toInt();
+                if (command.sound.id != 0 && !AC.sounds.contains(command.sound.id)) {
+                    request->send(404, "text/plain", "Sound not found");
+                    return;
                 }
-                request->send(204);
+                reply(request, commands::submit(command));
             } else {
                 request->send(400, "text/plain", "Missing parameter");
             }
         }
 
         void stop(AsyncWebServerRequest *request) {
-            AC.player.stop();
-            request->send(204);
+            commands::Command command{commands::Type::Stop};
+            reply(request, commands::submit(command));
+        }
+
+        /**
+         * @brief Skips a number within the given range
+         * @param p The first digit
+         * @return The character after the number or nullptr if there is no number within the range
+         */
+        const char *skipNumber(const char *p, long min, long max) {
+            if (!isdigit(*p)) return nullptr;
+            long value = 0;
+            while (isdigit(*p) && value <= max) value = value * 10 + (*p++ - '0');
+            return value >= min && value <= max ? p : nullptr;
+        }
+
+        /**
+         * @brief Skips the name of a standard or daylight saving time, e.g. CET or <+0330>
+         * @param p The first character of the name
+         * @return The character after the name or nullptr if there is no valid name
+         */
+        const char *skipTimeZoneName(const char *p) {
+            auto quoted = *p == '<';
+            auto *start = quoted ? ++p : p;
+            while (quoted ? isalnum(*p) || *p == '+' || *p == '-' : isalpha(*p)) ++p;
+            if (p - start < 3 || (quoted && *p != '>')) return nullptr;
+            return quoted ? p + 1 : p;
+        }
+
+        /**
+         * @brief Skips an offset or a time of a rule: [+|-]hh[:mm[:ss]]
+         * @param p The first character of the time
+         * @param maxHours The maximum number of hours
+         * @return The character after the time or nullptr if there is no valid time
+         */
+        const char *skipTimeZoneTime(const char *p, long maxHours) {
+            if (*p == '+' || *p == '-') ++p;
+            p = skipNumber(p, 0, maxHours);
+            for (uint8_t i = 0; i < 2 && p && *p == ':'; ++i) p = skipNumber(p + 1, 0, 59);
+            return p;
+        }
+
+        /**
+         * @brief Skips the date of a rule: Jn, n or Mm.w.d
+         * @param p The first character of the date
+         * @return The character after the date or nullptr if there is no valid date
+         */
+        const char *skipTimeZoneDate(const char *p) {
+            if (*p == 'J') return skipNumber(p + 1, 1, 365);
+            if (*p != 'M') return skipNumber(p, 0, 365);
+            p = skipNumber(p + 1, 1, 12);
+            if (p && *p == '.') p = skipNumber(p + 1, 1, 5);
+            else return nullptr;
+            if (p && *p == '.') return skipNumber(p + 1, 0, 6);
+            return nullptr;
+        }
+
+        /**
+         * @brief Checks the syntax of a POSIX time zone string: std offset [dst [offset] [,start[/time],end[/time]]],
+         * so the web handler can reject it before it is queued
+         * @param timeZone The time zone string, e.g. CET-1CEST,M3.5.0,M10.5.0/3
+         * @return true if the syntax is valid, false otherwise
+         */
+        bool isValidTimeZone(const char *timeZone) {
+            auto *p = skipTimeZoneName(timeZone);
+            if (p) p = skipTimeZoneTime(p, 24);
+            if (!p || *p == '\0') return p != nullptr;
+            p = skipTimeZoneName(p);
+            if (p && *p != ',' && *p != '\0') p = skipTimeZoneTime(p, 24);
+            if (!p || *p == '\0') return p != nullptr;
+            for (uint8_t i = 0; i < 2 && p; ++i) {
+                if (*p != ',') return false;
+                p = skipTimeZoneDate(p + 1);
+                // the time of a rule may exceed a day
+                if (p && *p == '/') p = skipTimeZoneTime(p + 1, 167);
+            }
+            return p && *p == '\0';
         }
 
         void putTimeZone(AsyncWebServerRequest *request, JsonVariant &json) {
             auto timeZone = json["timeZone"].as<const char *>();
-            if (setenv("TZ", timeZone, 1) == 0) {
-                tzset();
-                AC.tz = timeZone;
-                request->send(204);
-            } else {
+            if (timeZone == nullptr || strlen(timeZone) > TIME_ZONE_MAX_LENGTH || !isValidTimeZone(timeZone)) {
                 request->send(400, "text/plain", "Invalid time zone");
+                return;
             }
+            commands::Command command{commands::Type::SetTimeZone};
+            command.setText(timeZone);
+            reply(request, commands::submit(command));
+        }
+
+        void getLoopMetrics(AsyncWebServerRequest *request) {
+            DocumentResponse response{request, JSON_METRICS_BUF_SIZE};
+            auto &root = response.getRoot();
+            profiler::toJson(root);
+            response.send();
+            if (request->hasParam("reset")) profiler::reset();
+        }
+
+        void getI2CMetrics(AsyncWebServerRequest *request) {
+            DocumentResponse response{request, JSON_METRICS_BUF_SIZE};
+            auto &root = response.getRoot();
+            i2c::toJson(root);
+            response.send();
+            if (request->hasParam("reset")) i2c::reset();
+        }
+
+        void getAlarmMetrics(AsyncWebServerRequest *request) {
+            DocumentResponse response{request, JSON_METRICS_BUF_SIZE};
+            auto &root = response.getRoot();
+            root["cpuFreqMHz"] = ESP.getCpuFreqMHz();
+            profiler::alarmLatency.snapshot().toJson(root.createNestedObject("latency"));
+            response.send();
+            if (request->hasParam("reset")) profiler::alarmLatency.reset();
         }
 
         //#endregion
@@ -80,60 +192,76 @@ namespace AlarmClock {
         void getAlarm(AsyncWebServerRequest *request) {
             if (request->hasParam("id")) {
                 auto id = request->getParam("id")->value().toInt();
-                auto *response = new AsyncJsonResponse();
-                auto root = response->getRoot();
+                DocumentResponse response{request};
+                auto &root = response.getRoot();
                 switch (id) {
                     case 1:
-                        alarmToJson(AC.alarm1, root, AC.now);
+                        alarmToJson(AC.alarm1, root, AC.now.load());
                         break;
                     case 2:
-                        alarmToJson(AC.alarm2, root, AC.now);
+                        alarmToJson(AC.alarm2, root, AC.now.load());
                         break;
                     default:
                         request->send(404, "text/plain", "Invalid alarm id");
                         return;
                 }
-                response->setLength();
-                request->send(response);
+                response.send();
             } else {
                 request->send(400, "text/plain", "Missing parameter");
             }
         }
 
         void getLight(AsyncWebServerRequest *request) {
-            auto *response = new AsyncJsonResponse();
-            auto root = response->getRoot();
+            DocumentResponse response{request};
+            auto &root = response.getRoot();
             AC.mainLight.toJson(root);
-            response->setLength();
-            request->send(response);
+            response.send();
         }
 
         void getPlayer(AsyncWebServerRequest *request) {
-            auto *response = new AsyncJsonResponse();
-            auto root = response->getRoot();
+            DocumentResponse response{request};
+            auto &root = response.getRoot();
             root["volume"] = AC.player.getVolume();
-            response->setLength();
-            request->send(response);
+            auto catalog = AC.player.getCatalog();
+            root["files"] = catalog.files;
+            auto folders = root.createNestedArray("folders");
+            for (uint8_t i = 0; i < catalog.lastFolder; ++i) folders.add(catalog.folderFiles[i]);
+            response.send();
         }
 
+        /**
+         * @brief Sends the sounds as JSON array in chunks, serializing one sound at a time into the TCP buffer,
+         * so the memory needed does not depend on the number of sounds\n
+         * Query parameters: offset and limit select a page of sounds, fields a comma separated list of fields.
+         * The total number of sounds is sent in the X-Total-Count header.
+         */
         void getSounds(AsyncWebServerRequest *request) {
-            auto *response = new AsyncJsonResponse(true, JSON_SOUNDS_BUF_SIZE);
-            auto root = response->getRoot();
-            Sound::soundsToJson(AC.sounds, root);
-            response->setLength();
+            size_t offset = 0;
+            size_t limit = SIZE_MAX;
+            if (request->hasParam("offset")) offset = (size_t) max(request->getParam("offset")->value().toInt(), 0L);
+            if (request->hasParam("limit")) limit = (size_t) max(request->getParam("limit")->value().toInt(), 0L);
+            auto fields = request->hasParam("fields")
+                          ? SoundCatalog::parseFields(request->getParam("fields")->value())
+                          : SoundCatalog::ALL_FIELDS;
+            auto msgPack = DocumentResponse::acceptsMsgPack(request);
+            auto cursor = std::make_shared<SoundCatalog::ArrayCursor>(offset, limit, fields, msgPack);
+            auto *response = request->beginChunkedResponse(
+                    msgPack ? MSGPACK_CONTENT_TYPE : "application/json",
+                    [cursor](uint8_t *buffer, size_t maxLength, size_t) {
+                        return AC.sounds.fillArray(buffer, maxLength, *cursor);
+                    }
+            );
+            response->addHeader("X-Total-Count", String(AC.sounds.size()));
+            response->addHeader("Vary", "Accept");
             request->send(response);
         }
 
         void getSound(AsyncWebServerRequest *request) {
             if (request->hasParam("id")) {
-                auto id = (uint8_t) request->getParam("id")->value().toInt();
-                auto sPtr = Sound::getSoundById(id, AC.sounds);
-                if (sPtr != AC.sounds.end()) {
-                    auto *response = new AsyncJsonResponse();
-                    auto root = response->getRoot();
-                    sPtr->toJson(root);
-                    response->setLength();
-                    request->send(response);
+                auto id = (uint16_t) request->getParam("id")->value().toInt();
+                DocumentResponse response{request};
+                if (AC.sounds.toJson(id, response.getRoot())) {
+                    response.send();
                 } else {
                     request->send(404, "text/plain", "Sound not found");
                 }
@@ -142,107 +270,333 @@ namespace AlarmClock {
             }
         }
 
+        /**
+         * @brief Returns the entity tag of the state document, built from the state's version and the state that is
+         * not stored in beans, so it changes whenever the document does\n
+         * The version restarts at 0 on every boot, so the tag starts with the boot's nonce
+         * to never match a document of a previous boot.
+         * @return The quoted entity tag
+         */
+        String stateTag() {
+            auto version = beanRevision.load() + AC.sounds.getRevision();
+            return "\"" + String(bootNonce) + "-" + String(version) + "-" + String(AC.mainLight.getDuty()) + "-" +
+                   String((uint8_t) AC.alarm1.state) + String((uint8_t) AC.alarm2.state) + "-" +
+                   String(AC.player.getCatalog().files) + "\"";
+        }
+
+        /**
+         * @brief Sends the settings and state of the alarm clock as one document, so a page loads with one request\n
+         * The document is tagged with an ETag; if the client already has the current document, 304 is sent
+         * without building it. The time and the light level change constantly and are not part of the document,
+         * they are pushed by the event source. The sounds themselves are sent by GET /sounds.
+         */
+        void getState(AsyncWebServerRequest *request) {
+            auto tag = stateTag();
+            if (request->hasHeader("If-None-Match") && request->getHeader("If-None-Match")->value() == tag) {
+                auto *response = request->beginResponse(304);
+                response->addHeader("ETag", tag);
+                request->send(response);
+                return;
+            }
+            DocumentResponse response{request, JSON_STATE_BUF_SIZE};
+            auto &root = response.getRoot();
+            root["version"] = beanRevision.load() + AC.sounds.getRevision();
+            root["timeZone"] = String(AC.timeZone.load().data()); // tz is reassigned by the main loop
+            auto now = AC.now.load();
+            auto alarms = root.createNestedArray("alarms");
+            for (auto *alarm: {&AC.alarm1, &AC.alarm2}) {
+                auto json = alarms.createNestedObject();
+                alarmToJson(*alarm, json, now);
+                json["state"] = (uint8_t) alarm->state;
+            }
+            JsonVariant light = root.createNestedObject("light");
+            AC.mainLight.toJson(light);
+            auto player = root.createNestedObject("player");
+            player["volume"] = AC.player.getVolume();
+            auto catalog = AC.player.getCatalog();
+            player["files"] = catalog.files;
+            auto folders = player.createNestedArray("folders");
+            for (uint8_t i = 0; i < catalog.lastFolder; ++i) folders.add(catalog.folderFiles[i]);
+            auto sounds = root.createNestedObject("sounds");
+            sounds["count"] = AC.sounds.size();
+            sounds["revision"] = AC.sounds.getRevision();
+            auto *document = response.build();
+            document->addHeader("ETag", tag);
+            document->addHeader("Cache-Control", "no-cache");
+            request->send(document);
+        }
+
         //#endregion
         //#region data PUT, POST, DELETE
 
+        /**
+         * @brief Reads an integer member of a JSON object and checks its range, so it is not truncated
+         * @param json The JSON object
+         * @param key The key of the member
+         * @param max The maximum value of the member; the minimum is 0
+         * @param out The value to write to; 0 if the member is missing
+         * @return true if the member is missing or an integer within the range, false otherwise
+         */
+        template<typename T>
+        bool readInteger(const JsonVariant &json, const char *key, long max, T &out) {
+            auto member = json[key];
+            if (member.isNull()) {
+                out = 0;
+                return true;
+            }
+            if (!member.is<long>() || member.as<long>() < 0 || member.as<long>() > max) return false;
+            out = (T) member.as<long>();
+            return true;
+        }
+
         void putAlarm(AsyncWebServerRequest *request, JsonVariant &json) {
-            auto id = json["id"].as<uint8_t>();
-            switch (id) {
-                case 1:
-                    alarmFromJson(AC.alarm1, json);
-                    setAlarm(AC.alarm1, AC.rtc);
-                    break;
-                case 2:
-                    alarmFromJson(AC.alarm2, json);
-                    setAlarm(AC.alarm2, AC.rtc);
-                    break;
-                default:
-                    request->send(404, "text/plain", "Invalid alarm id");
-                    return;
+            commands::Command command{commands::Type::SetAlarm};
+            if (!readInteger(json, "id", 2, command.alarm.id) || command.alarm.id == 0) {
+                request->send(404, "text/plain", "Invalid alarm id");
+                return;
+            }
+            if (!readInteger(json, "hour", 23, command.alarm.hour) ||
+                !readInteger(json, "minute", 59, command.alarm.minute) ||
+                !readInteger(json, "repeat", 127, command.alarm.repeat) ||
+                !readInteger(json, "sound", UINT16_MAX, command.alarm.sound)) {
+                request->send(400, "text/plain", "Invalid alarm");
+                return;
             }
-            request->send(204);
+            command.alarm.toggle = json["toggle"].as<bool>();
+            reply(request, commands::submit(command));
         }
 
         void putAlarmIn8h(AsyncWebServerRequest *request) {
             if (request->hasParam("id")) {
-                auto id = request->getParam("id")->value().toInt();
-                switch (id) {
-                    case 1:
-                        setIn8hFromNow(AC.alarm1, AC.now);
-                        break;
-                    case 2:
-                        setIn8hFromNow(AC.alarm2, AC.now);
-                        break;
-                    default:
-                        request->send(404, "text/plain", "Invalid alarm id");
-                        return;
+                commands::Command command{commands::Type::SetAlarmIn8h};
+                command.alarm.id = (uint8_t) request->getParam("id")->value().toInt();
+                if (command.alarm.id != 1 && command.alarm.id != 2) {
+                    request->send(404, "text/plain", "Invalid alarm id");
+                    return;
                 }
-                request->send(204);
+                reply(request, commands::submit(command));
             } else {
                 request->send(400, "text/plain", "Missing parameter");
             }
         }
 
         void putLight(AsyncWebServerRequest *request, JsonVariant &json) {
-            AC.mainLight.fromJson(json);
-            request->send(204);
+            commands::Command command{commands::Type::SetLight};
+            if (!readInteger(json, "duty", UINT8_MAX, command.light.duty) ||
+                !readInteger(json, "duration", UINT8_MAX, command.light.duration)) {
+                request->send(400, "text/plain", "Invalid light");
+                return;
+            }
+            reply(request, commands::submit(command));
         }
 
         void putPlayer(AsyncWebServerRequest *request, JsonVariant &json) {
-            auto volume = json["volume"].as<uint8_t>();
-            if (volume > 30) {
+            commands::Command command{commands::Type::SetVolume};
+            if (!readInteger(json, "volume", 30, command.volume)) {
                 request->send(400, "text/plain", "Invalid must, be between 0 and 30");
                 return;
             }
-            AC.player.setVolume(volume);
-            request->send(204);
+            reply(request, commands::submit(command));
+        }
+
+        /**
+         * Collects the uploaded sounds in RAM, so the network stack does not write to flash and concurrent uploads
+         * do not share a file; the import command takes the body over\n
+         * The sounds are a JSON array, or a MessagePack array if the content type says so.
+         */
+        void putSoundsBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+            DocumentBody::collectUpTo(request, data, len, index, total, SOUNDS_UPLOAD_MAX_SIZE);
         }
 
-        void putSounds(AsyncWebServerRequest *request, JsonVariant &json) {
-            AC.sounds = Sound::soundsFromJson(json);
-            Sound::saveSounds(JSON_SOUNDS_FILE_NAME, AC.sounds);
-            request->send(204);
+        void putSounds(AsyncWebServerRequest *request) {
+            if (request->contentLength() > SOUNDS_UPLOAD_MAX_SIZE) {
+                request->send(413, "text/plain", "Too many sounds");
+                return;
+            }
+            if (request->_tempObject == nullptr) {
+                if (request->contentLength() == 0) request->send(400, "text/plain", "Missing body");
+                else request->send(503, "text/plain", "Not enough memory");
+                return;
+            }
+            if (commands::importPending.exchange(true)) {
+                request->send(409, "text/plain", "Import in progress");
+                return;
+            }
+            commands::Command command{commands::Type::ImportSounds};
+            command.upload.data = (uint8_t *) request->_tempObject;
+            command.upload.length = request->contentLength();
+            command.upload.msgPack = request->contentType().indexOf("msgpack") >= 0;
+            auto queued = commands::submit(command);
+            if (queued) request->_tempObject = nullptr; // freed by the command
+            else commands::importPending = false;
+            reply(request, queued);
         }
 
         void putSound(AsyncWebServerRequest *request, JsonVariant &json) {
-            auto sound = Sound::fromJson(json);
-            auto sPtr = Sound::getSoundById(sound.getId(), AC.sounds);
-            if (sPtr != AC.sounds.end()) {
-                *sPtr = sound;
-                Sound::saveSounds(JSON_SOUNDS_FILE_NAME, AC.sounds);
-                request->send(204);
-            } else {
+            commands::Command command{commands::Type::UpdateSound};
+            command.sound.id = json["id"].as<uint16_t>();
+            command.sound.allowRandom = json["allowRandom"].as<bool>();
+            auto name = json["name"].as<const char *>();
+            if (!AC.sounds.contains(command.sound.id)) {
                 request->send(404, "text/plain", "Sound not found");
+                return;
             }
+            if (name && strlen(name) > UINT8_MAX) {
+                request->send(400, "text/plain", "Name too long");
+                return;
+            }
+            command.setText(name);
+            reply(request, commands::submit(command));
         }
 
         void postSound(AsyncWebServerRequest *request, JsonVariant &json) {
-            auto sound = Sound::fromJson(json);
-            if (sound.getId() != AC.sounds.size() + 1) {
+            commands::Command command{commands::Type::AddSound};
+            command.sound.id = json["id"].as<uint16_t>();
+            command.sound.allowRandom = json["allowRandom"].as<bool>();
+            command.sound.folder = json["folder"] | (uint8_t) 0;
+            command.sound.track = json["track"] | (uint16_t) 0;
+            auto name = json["name"].as<const char *>();
+            if (command.sound.id == 0 || AC.sounds.contains(command.sound.id)) {
                 request->send(400, "text/plain", "Invalid sound id");
                 return;
             }
-            AC.sounds.push_back(sound);
-            request->send(204);
+            if (name && strlen(name) > UINT8_MAX) {
+                request->send(400, "text/plain", "Name too long");
+                return;
+            }
+            command.setText(name);
+            reply(request, commands::submit(command));
         }
 
         void deleteSound(AsyncWebServerRequest *request) {
             if (request->hasParam("id")) {
-                auto id = (uint8_t) request->getParam("id")->value().toInt();
-                auto sPtr = Sound::getSoundById(id, AC.sounds);
-                if (sPtr != AC.sounds.end()) {
-                    AC.sounds.erase(sPtr);
-                    Sound::saveSounds(JSON_SOUNDS_FILE_NAME, AC.sounds);
-                }
-                request->send(204);
+                commands::Command command{commands::Type::RemoveSound};
+                command.sound.id = (uint16_t) request->getParam("id")->value().toInt();
+                // removing a sound that does not exist is not an error, so there is no result to wait for
+                reply(request, commands::submit(command));
             } else {
                 request->send(400, "text/plain", "Missing parameter");
             }
         }
 
         //#endregion
+        //#region live events
+
+        /**
+         * @brief Queues an event with the given JSON data for all connected clients
+         * @param event The name of the event
+         * @param doc The JSON data
+         */
+        void pushEvent(const char *event, const JsonDocument &doc) {
+            Event queued{};
+            strncpy(queued.name.data(), event, queued.name.size() - 1);
+            serializeJson(doc, queued.data.data(), queued.data.size());
+            xQueueSend(eventQueue, &queued, 0);
+        }
+
+        /**
+         * @brief Sends the queued events to the clients of the event source\n
+         * Must be called by the network task, which owns the clients and their message queues.
+         */
+        void sendEvents() {
+            Event event;
+            while (xQueueReceive(eventQueue, &event, 0) == pdTRUE) {
+                eventSource.send(event.data.data(), event.name.data(), millis());
+            }
+        }
+
+        /**
+         * @brief Pushes the state that changed since the last call to the clients of the event source\n
+         * Should be called by the main loop after it handled its events. The state is compared against the state
+         * that was pushed last, so only changes are sent, whichever task made them. A client that connects
+         * gets all state once. The events are queued and sent by the network task when it polls the clients,
+         * as the event source is not thread safe; while the queue is full, e.g. as no client is connected,
+         * nothing is pushed.
+         * Events: time, light_sensor (if the level changed by more than the threshold), alarm, light,
+         * player and sounds (the revision of the sounds, to be fetched again).
+         */
+        void pushChanges() {
+            static uint32_t time{0};
+            static float lightLevel{-1.0f};
+            static std::array<uint64_t, 2> alarms{}; // the settings and state of each alarm, packed
+            static uint32_t lightDuty{UINT32_MAX};
+            static uint8_t volume{UINT8_MAX};
+            static uint32_t soundsRevision{UINT32_MAX};
+            if (uxQueueSpacesAvailable(eventQueue) < WEB_EVENTS_PER_PUSH) return;
+            bool all = eventResync.exchange(false);
+            StaticJsonDocument<JSON_EVENT_BUF_SIZE> doc;
+
+            auto now = AC.now.load();
+            if (all || now.unixtime() != time) {
+                time = now.unixtime();
+                doc["value"] = time;
+                pushEvent("time", doc);
+            }
+            auto level = AC.lightLevel;
+            if (all || fabsf(level - lightLevel) > max(lightLevel * EVENT_LIGHT_LEVEL_THRESHOLD, 1.0f)) {
+                lightLevel = level;
+                doc.clear();
+                doc["value"] = level;
+                pushEvent("light_sensor", doc);
+            }
+            for (auto *alarm: {&AC.alarm1, &AC.alarm2}) {
+                auto &last = alarms[nToInt(alarm->n) - 1];
+                uint64_t current = (uint64_t) alarm->state << 35 | (uint64_t) (bool) alarm->toggle << 34 |
+                                   (uint64_t) (uint8_t) alarm->repeat << 27 | (uint64_t) (uint8_t) alarm->hour << 22 |
+                                   (uint64_t) (uint8_t) alarm->minute << 16 | (uint16_t) alarm->sound;
+                if (!all && current == last) continue;
+                last = current;
+                doc.clear();
+                alarmToJson(*alarm, doc.to<JsonObject>(), now);
+                doc["state"] = (uint8_t) alarm->state;
+                pushEvent("alarm", doc);
+            }
+            if (all || AC.mainLight.getDuty() != lightDuty) {
+                lightDuty = AC.mainLight.getDuty();
+                doc.clear();
+                JsonVariant root = doc.to<JsonObject>();
+                AC.mainLight.toJson(root);
+                pushEvent("light", doc);
+            }
+            if (all || AC.player.getVolume() != volume) {
+                volume = AC.player.getVolume();
+                doc.clear();
+                doc["volume"] = volume;
+                pushEvent("player", doc);
+            }
+            if (all || AC.sounds.getRevision() != soundsRevision) {
+                soundsRevision = AC.sounds.getRevision();
+                doc.clear();
+                doc["revision"] = soundsRevision;
+                doc["count"] = AC.sounds.size();
+                pushEvent("sounds", doc);
+            }
+        }
+
+        //#endregion
+
+        /**
+         * @brief Registers a handler for requests with a JSON or MessagePack body, as told by their content type
+         * @param server The web server
+         * @param uri The uri to handle
+         * @param method The method to handle
+         * @param handler The handler, called with the parsed body; requests without a valid body are answered with 400
+         */
+        void onDocument(AsyncWebServer &server, const char *uri, WebRequestMethod method,
+                        void (*handler)(AsyncWebServerRequest *, JsonVariant &)) {
+            server.on(uri, method, [handler](AsyncWebServerRequest *request) {
+                DynamicJsonDocument doc{JSON_DOCUMENT_BUF_SIZE};
+                if (!DocumentBody::parse(request, doc)) {
+                    request->send(400, "text/plain", "Invalid body");
+                    return;
+                }
+                JsonVariant json = doc.as<JsonVariant>();
+                handler(request, json);
+            }, nullptr, DocumentBody::collect);
+        }
 
         void setup(AsyncWebServer &server) {
+            bootNonce = esp_random();
             server.serveStatic("/", SPIFFS, "/root_site/").setDefaultFile("index.html");
 
             // general GET
@@ -252,9 +606,10 @@ namespace AlarmClock {
             server.on("/light_sensor", HTTP_GET, getLightSensor);
             server.on("/play", HTTP_GET, play);
             server.on("/stop", HTTP_GET, stop);
-            auto putTimeZoneHandler = new AsyncCallbackJsonWebHandler("/time_zone", putTimeZone);
-            putTimeZoneHandler->setMethod(HTTP_PUT);
-            server.addHandler(putTimeZoneHandler);
+            server.on("/metrics/loop", HTTP_GET, getLoopMetrics);
+            server.on("/metrics/alarm", HTTP_GET, getAlarmMetrics);
+            server.on("/metrics/i2c", HTTP_GET, getI2CMetrics);
+            onDocument(server, "/time_zone", HTTP_PUT, putTimeZone);
 
             // data GET
 
@@ -263,30 +618,34 @@ namespace AlarmClock {
             server.on("/player", HTTP_GET, getPlayer);
             server.on("/sounds", HTTP_GET, getSounds);
             server.on("/sound", HTTP_GET, getSound);
+            server.on("/state", HTTP_GET, getState);
 
             // data PUT, POST, DELETE
 
-            auto putAlarmHandler = new AsyncCallbackJsonWebHandler("/alarm", putAlarm);
-            putAlarmHandler->setMethod(HTTP_PUT);
-            server.addHandler(putAlarmHandler);
+            // registered before /alarm, which would handle its sub paths as well
             server.on("/alarm/in8h", HTTP_PUT, putAlarmIn8h);
-            auto putLightHandler = new AsyncCallbackJsonWebHandler("/light", putLight);
-            putLightHandler->setMethod(HTTP_PUT);
-            server.addHandler(putLightHandler);
-            auto putPlayerHandler = new AsyncCallbackJsonWebHandler("/player", putPlayer);
-            putPlayerHandler->setMethod(HTTP_PUT);
-            server.addHandler(putPlayerHandler);
-            auto putSoundsHandler = new AsyncCallbackJsonWebHandler("/sounds", putSounds);
-            putSoundsHandler->setMethod(HTTP_PUT);
-            server.addHandler(putSoundsHandler);
-            auto putSoundHandler = new AsyncCallbackJsonWebHandler("/sound", putSound);
-            putSoundHandler->setMethod(HTTP_PUT);
-            server.addHandler(putSoundHandler);
-            auto postSoundHandler = new AsyncCallbackJsonWebHandler("/sound", postSound);
-            postSoundHandler->setMethod(HTTP_POST);
-            server.addHandler(postSoundHandler);
+            onDocument(server, "/alarm", HTTP_PUT, putAlarm);
+            onDocument(server, "/light", HTTP_PUT, putLight);
+            onDocument(server, "/player", HTTP_PUT, putPlayer);
+            server.on("/sounds", HTTP_PUT, putSounds, nullptr, putSoundsBody);
+            onDocument(server, "/sound", HTTP_PUT, putSound);
+            onDocument(server, "/sound", HTTP_POST, postSound);
             server.on("/sound", HTTP_DELETE, deleteSound);
 
+            // live events
+
+            eventQueue = xQueueCreate(WEB_EVENT_QUEUE_SIZE, sizeof(Event));
+            assert(eventQueue && "Failed to create web event queue");
+            eventSource.onConnect([](AsyncEventSourceClient *client) {
+                // the queued events are stale, all state is pushed again
+                xQueueReset(eventQueue);
+                eventResync = true;
+                scheduler::notify(scheduler::WEB_COMMAND);
+                // replaces the event source's poll, which only retries the sending its ack handler retries as well
+                client->client()->onPoll([](void *, AsyncClient *) { sendEvents(); });
+            });
+            server.addHandler(&eventSource);
+
 
             server.begin();
             AsyncElegantOTA.setID("AlarmClock");
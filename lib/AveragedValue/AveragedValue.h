@@ -7,9 +7,11 @@
 
 #if __cplusplus >= 201103L
 
+#include <algorithm>
 #include <array>
 #include <functional>
 #include <numeric>
+#include <type_traits>
 #include "AveragedValue.hpp"
 
 #else
@@ -6,18 +6,166 @@
 #define ALARM_CLOCK_R2V6_AVERAGED_VALUE_HPP
 
 
+/**
+ * The filter policies an AveragedValue can use.\n
+ * A filter is a class template taking the value type and the window size;
+ * it has to provide a method <code>T update(T newValue)</code> returning the filtered value
+ * as well as a method <code>void fill(T value)</code> initializing the whole window with a value.
+ */
+namespace filter {
+
+    /**
+     * A filter calculating the mean of the last n values.
+     * Uses a ring buffer and a running sum, so updating runs in constant time.
+     * @tparam T the type of the values
+     * @tparam n the number of values to average
+     */
+    template<typename T, size_t n>
+    class Mean {
+
+        using Sum = typename std::conditional<std::is_floating_point<T>::value, T, long long>::type;
+
+        std::array<T, n> values{};
+        size_t index{0};
+        Sum sum{};
+
+    public:
+        void fill(T value) {
+            values.fill(value);
+            index = 0;
+            sum = (Sum) value * n;
+        }
+
+        T update(T newValue) {
+            sum += (Sum) newValue - values[index];
+            values[index] = newValue;
+            if (++index == n) {
+                index = 0;
+                // recalculate the sum once per round to prevent floating point errors from accumulating
+                sum = std::accumulate(std::begin(values), std::end(values), (Sum) 0);
+            }
+            return (T) (sum / (Sum) n);
+        }
+    };
+
+    /**
+     * A filter calculating the exponential moving average with a smoothing factor of 2 / (n + 1),
+     * which weights the values similar to a mean of the last n values without storing them.
+     * @tparam T the type of the values
+     * @tparam n the number of values the smoothing factor corresponds to
+     */
+    template<typename T, size_t n>
+    class Exponential {
+
+        static constexpr float ALPHA = 2.0f / (n + 1);
+
+        float average{};
+
+    public:
+        void fill(T value) { average = (float) value; }
+
+        T update(T newValue) {
+            average += ((float) newValue - average) * ALPHA;
+            return (T) average;
+        }
+    };
+
+    /**
+     * A filter calculating the running median of the last 3 or 5 values, suppressing single spikes.
+     * @tparam T the type of the values
+     * @tparam n the number of values to calculate the median of; either 3 or 5
+     */
+    template<typename T, size_t n>
+    class Median {
+        static_assert(n == 3 || n == 5, "The running median is only available for 3 or 5 values");
+
+        std::array<T, n> values{};
+        std::array<T, n> sorted{};
+        size_t index{0};
+
+    public:
+        void fill(T value) {
+            values.fill(value);
+            sorted.fill(value);
+            index = 0;
+        }
+
+        T update(T newValue) {
+            // replace the oldest value in the sorted window and restore the order by moving the new value
+            auto i = (size_t) (std::find(std::begin(sorted), std::end(sorted), values[index]) - std::begin(sorted));
+            sorted[i] = newValue;
+            for (; i > 0 && sorted[i - 1] > sorted[i]; --i) std::swap(sorted[i - 1], sorted[i]);
+            for (; i < n - 1 && sorted[i + 1] < sorted[i]; ++i) std::swap(sorted[i + 1], sorted[i]);
+            values[index] = newValue;
+            index = (index + 1) % n;
+            return sorted[n / 2];
+        }
+    };
+
+    /**
+     * A filter tracking the minimum and maximum of the last n values; the filtered value is their midrange.
+     * The extremes are only searched for again if the value leaving the window was one of them.
+     * @tparam T the type of the values
+     * @tparam n the number of values to track
+     */
+    template<typename T, size_t n>
+    class MinMax {
+
+        std::array<T, n> values{};
+        size_t index{0};
+        T minValue{};
+        T maxValue{};
+
+    public:
+        void fill(T value) {
+            values.fill(value);
+            index = 0;
+            minValue = maxValue = value;
+        }
+
+        T update(T newValue) {
+            auto oldValue = values[index];
+            values[index] = newValue;
+            index = (index + 1) % n;
+            if (oldValue == minValue && newValue > minValue) {
+                minValue = *std::min_element(std::begin(values), std::end(values));
+            } else if (newValue < minValue) {
+                minValue = newValue;
+            }
+            if (oldValue == maxValue && newValue < maxValue) {
+                maxValue = *std::max_element(std::begin(values), std::end(values));
+            } else if (newValue > maxValue) {
+                maxValue = newValue;
+            }
+            return (T) (minValue + (maxValue - minValue) / 2);
+        }
+
+        /**
+         * @return the minimum of the last n values
+         */
+        T min() const { return minValue; }
+
+        /**
+         * @return the maximum of the last n values
+         */
+        T max() const { return maxValue; }
+    };
+
+}
+
 /**
  * A class storing a value averaged over the last n values.
  * @tparam T the type of the values
  * @tparam n the number of values to average
+ * @tparam Filter the filter policy used to average the values, see the filter namespace
  */
-template<typename T, size_t n>
+template<typename T, size_t n, template<typename, size_t> class Filter = filter::Mean>
 class AveragedValue {
 
 private:
     T value{};
-    std::array <T, n> values{};
-    size_t initialReads{n};
+    Filter<T, n> filter{};
+    bool initialized{false};
 
 public:
     AveragedValue() = default;
@@ -27,23 +175,25 @@ public:
      */
     T get() const { return value; }
 
+    /**
+     * @return the filter policy, e.g. to access the extremes tracked by filter::MinMax
+     */
+    const Filter<T, n> &getFilter() const { return filter; }
+
     /**
      * Updates the average with a new value.
      * @param newValue the new value
      */
     typename std::enable_if<std::is_arithmetic<T>::value>::type
     update(T newValue) {
-        if (initialReads > 0) {
+        if (!initialized) {
             // fill all uninitialized values
-            for (size_t i = n - initialReads; i < n; ++i) values[i] = newValue;
-            initialReads--;
+            filter.fill(newValue);
+            initialized = true;
+            value = newValue;
         } else {
-            // shift all values one to the left
-            std::copy(std::begin(values) + 1, std::end(values), std::begin(values));
-            values[n - 1] = newValue;
+            value = filter.update(newValue);
         }
-        // calculate the new average
-        value = std::accumulate(std::begin(values), std::end(values), (T) 0.0) / n;
     }
 
     /**
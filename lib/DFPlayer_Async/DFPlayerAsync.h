@@ -0,0 +1,16 @@
+#ifndef DFPLAYER_ASYNC_H
+#define DFPLAYER_ASYNC_H
+
+#if __cplusplus >= 201103L
+
+#include <Arduino.h>
+#include <array>
+#include <functional>
+#include <freertos/queue.h>
+#include "DFPlayerAsync.hpp"
+
+#else
+#error "This library needs at least C++11"
+#endif
+
+#endif //DFPLAYER_ASYNC_H
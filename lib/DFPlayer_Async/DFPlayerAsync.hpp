@@ -0,0 +1,353 @@
+#ifndef DFPLAYER_ASYNC_HPP
+#define DFPLAYER_ASYNC_HPP
+
+
+/**
+ * @brief Non-blocking driver for the DFPlayer Mini.
+ *
+ * Commands are put into a bounded queue and sent by the driver's own task, so callers never wait for the serial line.
+ * The task parses the frames received from the player, verifies their checksums and matches the acknowledgements
+ * of the sent commands; a command that was not acknowledged in time or was rejected by the player is sent again.
+ * Events of the player, e.g. a finished track or a removed card, and the answers to queries are reported to callbacks,
+ * which are called from the driver's task and therefore must not block.
+ */
+class DFPlayerAsync {
+
+public:
+
+    /**
+     * The events reported to the event callback
+     */
+    enum class Event {
+        Online, // the player responded to the initial query
+        TrackFinished, // the parameter is the finished track
+        CardInserted,
+        CardRemoved,
+        Error, // the player reported an error; the parameter is the error code
+        CommandFailed, // a command was not acknowledged after all retries; the parameter is the command
+        Acknowledged // the player acknowledged a command; the parameter is the command
+    };
+
+    using EventCallback = std::function<void(Event, uint16_t)>;
+
+    /**
+     * The callback the answers to queries are reported to; called with the query command and the answered value
+     */
+    using ResponseCallback = std::function<void(uint8_t, uint16_t)>;
+
+    /**
+     * The commands of the DFPlayer Mini
+     */
+    enum Command : uint8_t {
+        PLAY_TRACK = 0x03,
+        SET_VOLUME = 0x06,
+        SET_EQ = 0x07,
+        LOOP_TRACK = 0x08,
+        SET_DEVICE = 0x09,
+        PLAY_FOLDER = 0x0F, // the parameter's high byte is the folder, the low byte the track
+        PLAY_LARGE_FOLDER = 0x14, // the parameter's high nibble is the folder, the other 12 bits the track
+        STOP = 0x16,
+        REPEAT_CURRENT = 0x19, // repeats the current track if the parameter is 0, stops repeating if it is 1
+        QUERY_STATUS = 0x42,
+        QUERY_FILES = 0x48, // the number of files on the SD card
+        QUERY_FOLDER_FILES = 0x4E, // the number of files in the folder given as parameter
+        QUERY_FOLDERS = 0x4F // the number of folders on the SD card
+    };
+
+    static constexpr uint8_t EQ_NORMAL = 0;
+    static constexpr uint8_t DEVICE_SD = 2;
+    static constexpr uint8_t LARGE_FOLDERS = 15; // the folders a track beyond 255 can be played from
+    static constexpr uint16_t LARGE_FOLDER_TRACKS = 3000;
+
+    DFPlayerAsync() = default;
+
+    /**
+     * @brief Starts the driver's task and checks whether the player responds; blocks at most the ACK timeout.
+     * @param serial The serial the player is connected to; must already be started with 9600 baud
+     * @return true if the player responded, false otherwise
+     */
+    bool begin(HardwareSerial &serial) {
+        assert(task == nullptr);
+        this->serial = &serial;
+        queue = xQueueCreate(QUEUE_SIZE, sizeof(Request));
+        assert(queue != nullptr && "Could not create DFPlayer command queue");
+        auto result = xTaskCreate(
+                [](void *param) { static_cast<DFPlayerAsync *>(param)->run(); },
+                "dfplayer",
+                3072,
+                this,
+                TASK_PRIORITY,
+                &task
+        );
+        assert(result == pdPASS && "Could not create DFPlayer task");
+        serial.onReceive([this]() { xTaskNotifyGive(task); });
+        send(QUERY_STATUS);
+        for (uint32_t waited = 0; !online && waited < ACK_TIMEOUT; waited += 10) vTaskDelay(pdMS_TO_TICKS(10));
+        return online;
+    }
+
+    /**
+     * @brief Sets the callback the player's events are reported to
+     * @param callback The callback; called from the driver's task
+     */
+    void onEvent(const EventCallback &callback) { eventCallback = callback; }
+
+    /**
+     * @brief Sets the callback the answers to queries are reported to
+     * @param callback The callback; called from the driver's task
+     */
+    void onResponse(const ResponseCallback &callback) { responseCallback = callback; }
+
+    /**
+     * @brief Queues a command without waiting for it to be sent
+     * @param command The command to send
+     * @param param The parameter of the command
+     * @return true if the command was queued, false if the queue is full
+     */
+    bool send(uint8_t command, uint16_t param = 0) {
+        Request request{command, param, 0};
+        if (xQueueSend(queue, &request, 0) != pdTRUE) return false;
+        xTaskNotifyGive(task);
+        return true;
+    }
+
+    bool play(uint16_t track) { return send(PLAY_TRACK, track); }
+
+    bool loop(uint16_t track) { return send(LOOP_TRACK, track); }
+
+    /**
+     * @brief Queues playing a track of a numbered folder
+     * @param folder The folder; 1 to 99
+     * @param track The track in the folder; 1 to 255, or 1 to 3000 for the folders 1 to 15
+     * @return true if the command was queued, false if the queue is full or the track cannot be addressed
+     */
+    bool playFolder(uint8_t folder, uint16_t track) {
+        if (track <= UINT8_MAX) return send(PLAY_FOLDER, (uint16_t) (folder << 8 | track));
+        if (folder <= LARGE_FOLDERS && track <= LARGE_FOLDER_TRACKS) {
+            return send(PLAY_LARGE_FOLDER, (uint16_t) (folder << 12 | track));
+        }
+        return false;
+    }
+
+    /**
+     * @brief Queues playing a track of a numbered folder in a loop
+     * @param folder The folder; 1 to 99
+     * @param track The track in the folder; see playFolder()
+     * @return true if the commands were queued, false otherwise
+     */
+    bool loopFolder(uint8_t folder, uint16_t track) { return playFolder(folder, track) && send(REPEAT_CURRENT, 0); }
+
+    bool stop() { return send(STOP); }
+
+    bool volume(uint8_t volume) { return send(SET_VOLUME, volume); }
+
+    bool EQ(uint8_t eq) { return send(SET_EQ, eq); }
+
+    bool outputDevice(uint8_t device) { return send(SET_DEVICE, device); }
+
+    /**
+     * @return true if a track is playing, as far as known from the sent commands and the reported events
+     */
+    bool isPlaying() const { return playing; }
+
+    /**
+     * @return the number of received frames with an invalid checksum
+     */
+    uint32_t getChecksumErrors() const { return checksumErrors; }
+
+    /**
+     * @return the number of commands that were sent again
+     */
+    uint32_t getRetries() const { return retries; }
+
+    // delete copy constructor and assignment operator
+
+    DFPlayerAsync(const DFPlayerAsync &) = delete;
+
+    DFPlayerAsync &operator=(const DFPlayerAsync &) = delete;
+
+private:
+
+    static constexpr uint8_t FRAME_SIZE = 10;
+    static constexpr uint8_t FRAME_START = 0x7E;
+    static constexpr uint8_t FRAME_VERSION = 0xFF;
+    static constexpr uint8_t FRAME_LENGTH = 0x06;
+    static constexpr uint8_t FRAME_END = 0xEF;
+    static constexpr uint8_t QUEUE_SIZE = 16;
+    static constexpr UBaseType_t TASK_PRIORITY = 3;
+    static constexpr uint32_t ACK_TIMEOUT = 500; // ms
+    static constexpr uint32_t RETRY_DELAY = 100; // ms, after the player reported to be busy
+    static constexpr uint8_t MAX_RETRIES = 3;
+
+    static constexpr uint8_t RESPONSE_CARD_INSERTED = 0x3A;
+    static constexpr uint8_t RESPONSE_CARD_REMOVED = 0x3B;
+    static constexpr uint8_t RESPONSE_TRACK_FINISHED = 0x3D;
+    static constexpr uint8_t RESPONSE_ERROR = 0x40;
+    static constexpr uint8_t RESPONSE_ACK = 0x41;
+    static constexpr uint16_t ERROR_BUSY = 0x01;
+    static constexpr uint16_t ERROR_SERIAL = 0x03; // the player received an incomplete frame
+    static constexpr uint16_t ERROR_CHECKSUM = 0x04;
+
+    struct Request {
+        uint8_t command;
+        uint16_t param;
+        uint8_t attempts;
+    };
+
+    HardwareSerial *serial{nullptr};
+    QueueHandle_t queue{nullptr};
+    TaskHandle_t task{nullptr};
+    EventCallback eventCallback{};
+    ResponseCallback responseCallback{};
+    volatile bool online{false};
+    volatile bool playing{false};
+    volatile bool looping{false};
+    volatile uint32_t checksumErrors{0};
+    volatile uint32_t retries{0};
+
+    // owned by the driver's task
+    std::array<uint8_t, FRAME_SIZE> rxFrame{};
+    uint8_t rxLength{0};
+    Request inFlight{};
+    bool awaitingAck{false};
+    TickType_t deadline{0};
+
+    static uint16_t checksum(const uint8_t *frame) {
+        uint16_t sum = 0;
+        for (uint8_t i = 1; i < 7; ++i) sum += frame[i];
+        return (uint16_t) -sum;
+    }
+
+    void report(Event event, uint16_t param) { if (eventCallback) eventCallback(event, param); }
+
+    void transmit(const Request &request) {
+        std::array<uint8_t, FRAME_SIZE> frame{
+                FRAME_START, FRAME_VERSION, FRAME_LENGTH, request.command, 0x01 /* request ACK */,
+                (uint8_t) (request.param >> 8), (uint8_t) request.param, 0, 0, FRAME_END
+        };
+        auto sum = checksum(frame.data());
+        frame[7] = (uint8_t) (sum >> 8);
+        frame[8] = (uint8_t) sum;
+        serial->write(frame.data(), frame.size());
+        switch (request.command) {
+            case PLAY_TRACK:
+            case LOOP_TRACK:
+            case PLAY_FOLDER:
+            case PLAY_LARGE_FOLDER:
+                playing = true;
+                looping = request.command == LOOP_TRACK;
+                break;
+            case REPEAT_CURRENT:
+                looping = request.param == 0;
+                break;
+            case STOP:
+                playing = false;
+                looping = false;
+                break;
+            default:
+                break;
+        }
+    }
+
+    /**
+     * @brief Sends the in-flight command again or gives up on it if it ran out of retries
+     * @param delay The delay before the command is sent again
+     */
+    void retry(uint32_t delay) {
+        if (++inFlight.attempts > MAX_RETRIES) {
+            awaitingAck = false;
+            report(Event::CommandFailed, inFlight.command);
+            return;
+        }
+        retries++;
+        if (delay) vTaskDelay(pdMS_TO_TICKS(delay));
+        transmit(inFlight);
+        deadline = xTaskGetTickCount() + pdMS_TO_TICKS(ACK_TIMEOUT);
+    }
+
+    void handleFrame(uint8_t command, uint16_t param) {
+        online = true;
+        switch (command) {
+            case RESPONSE_ACK:
+                if (awaitingAck) report(Event::Acknowledged, inFlight.command);
+                awaitingAck = false;
+                break;
+            case RESPONSE_ERROR:
+                // only commands the player could not take are sent again, a rejected one would fail again
+                if (awaitingAck) {
+                    if (param == ERROR_BUSY) retry(RETRY_DELAY);
+                    else if (param == ERROR_SERIAL || param == ERROR_CHECKSUM) retry(0);
+                    else awaitingAck = false;
+                }
+                report(Event::Error, param);
+                break;
+            case RESPONSE_TRACK_FINISHED:
+                playing = looping;
+                report(Event::TrackFinished, param);
+                break;
+            case RESPONSE_CARD_INSERTED:
+                report(Event::CardInserted, param);
+                break;
+            case RESPONSE_CARD_REMOVED:
+                playing = false;
+                looping = false;
+                report(Event::CardRemoved, param);
+                break;
+            case QUERY_STATUS:
+                if (inFlight.command == QUERY_STATUS) report(Event::Online, param);
+                break;
+            case QUERY_FILES:
+            case QUERY_FOLDER_FILES:
+            case QUERY_FOLDERS:
+                // the answer acknowledges the query as well
+                if (awaitingAck && inFlight.command == command) awaitingAck = false;
+                if (responseCallback) responseCallback(command, param);
+                break;
+            default:
+                break;
+        }
+    }
+
+    /**
+     * @brief Parses all received bytes; resynchronizes on the start byte if a frame is malformed
+     */
+    void receive() {
+        while (serial->available() > 0) {
+            auto byte = (uint8_t) serial->read();
+            if (rxLength == 0 && byte != FRAME_START) continue;
+            rxFrame[rxLength++] = byte;
+            if (rxLength < FRAME_SIZE) continue;
+            rxLength = 0;
+            if (rxFrame[1] != FRAME_VERSION || rxFrame[2] != FRAME_LENGTH || rxFrame[9] != FRAME_END) continue;
+            if (checksum(rxFrame.data()) != (uint16_t) (rxFrame[7] << 8 | rxFrame[8])) {
+                checksumErrors++;
+                continue;
+            }
+            handleFrame(rxFrame[3], (uint16_t) (rxFrame[5] << 8 | rxFrame[6]));
+        }
+    }
+
+    [[noreturn]] void run() {
+        TickType_t wait = portMAX_DELAY;
+        for (;;) {
+            ulTaskNotifyTake(pdTRUE, wait);
+            receive();
+            if (awaitingAck && (int32_t) (xTaskGetTickCount() - deadline) >= 0) retry(0);
+            if (!awaitingAck && xQueueReceive(queue, &inFlight, 0) == pdTRUE) {
+                transmit(inFlight);
+                awaitingAck = true;
+                deadline = xTaskGetTickCount() + pdMS_TO_TICKS(ACK_TIMEOUT);
+            }
+            if (awaitingAck) {
+                auto now = xTaskGetTickCount();
+                wait = (int32_t) (deadline - now) > 0 ? deadline - now : 0;
+            } else {
+                wait = uxQueueMessagesWaiting(queue) > 0 ? 0 : portMAX_DELAY;
+            }
+        }
+    }
+
+};
+
+
+#endif //DFPLAYER_ASYNC_HPP
@@ -0,0 +1,16 @@
+#ifndef ESP32_I2C_BUS_H
+#define ESP32_I2C_BUS_H
+
+#if __cplusplus >= 201103L
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <vector>
+#include <freertos/semphr.h>
+#include "I2CBus.hpp"
+
+#else
+#error "This library needs at least C++11"
+#endif
+
+#endif //ESP32_I2C_BUS_H
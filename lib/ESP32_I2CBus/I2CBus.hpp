@@ -0,0 +1,207 @@
+#ifndef ESP32_I2C_BUS_HPP
+#define ESP32_I2C_BUS_HPP
+
+
+/**
+ * @brief Class arbitrating the access of multiple devices to a shared I2C bus.
+ *
+ * All accesses are done within a transaction, which holds the bus' mutex for its lifetime.
+ * The mutex is a recursive FreeRTOS mutex, so waiting tasks get the bus in the order of their priority
+ * and a task holding the bus inherits the priority of a higher prioritized waiting task.
+ * Each device has its own clock frequency, which the bus switches to at the start of a transaction,
+ * and collects statistics about its transactions.
+ */
+class I2CBus {
+
+public:
+
+    class Transaction;
+
+    /**
+     * @brief Statistics of the transactions with a device.
+     * Bytes and NACKs are only counted for transmissions ended through the transaction,
+     * so they are only meaningful for devices whose driver does so, see Device::countsTransfers().
+     */
+    struct Stats {
+        uint32_t transactions{0};
+        uint32_t bytes{0};
+        uint32_t nacks{0};
+        uint64_t totalUs{0};
+        uint32_t maxUs{0};
+        uint32_t maxWaitUs{0}; // the longest time a transaction waited for the bus
+    };
+
+    /**
+     * @brief A device on the bus.
+     */
+    class Device {
+
+        friend class I2CBus;
+        friend class Transaction;
+
+        I2CBus &bus;
+        const char *name;
+        const uint8_t address;
+        const uint32_t frequency;
+        const bool counted;
+        Stats stats{};
+
+    public:
+
+        /**
+         * @brief Creates a device and registers it on the bus.
+         * @param bus the bus the device is connected to
+         * @param name the name of the device; used for the statistics
+         * @param address the I2C address of the device
+         * @param frequency the clock frequency to use for the device
+         * @param counted whether the device's driver ends its transmissions through the transaction,
+         * so its bytes and NACKs are counted; drivers using the wire on their own are not counted
+         */
+        Device(I2CBus &bus, const char *name, uint8_t address, uint32_t frequency = 400000, bool counted = false)
+                : bus(bus), name(name), address(address), frequency(frequency), counted(counted) {
+            bus.devices.push_back(this);
+        }
+
+        I2CBus &getBus() const { return bus; }
+
+        const char *getName() const { return name; }
+
+        uint8_t getAddress() const { return address; }
+
+        uint32_t getFrequency() const { return frequency; }
+
+        /**
+         * @return whether the bytes and NACKs of the device are counted
+         */
+        bool countsTransfers() const { return counted; }
+
+        const Stats &getStats() const { return stats; }
+
+        void resetStats() { stats = Stats{}; }
+
+        // delete copy constructor and assignment operator
+
+        Device(const Device &) = delete;
+
+        Device &operator=(const Device &) = delete;
+
+    };
+
+    /**
+     * @brief A transaction with a device; holds the bus for its lifetime.
+     * Transactions may be nested within the same task.
+     */
+    class Transaction {
+
+        Device &device;
+        int64_t start{0};
+
+    public:
+
+        /**
+         * @brief Waits for the bus, takes it and switches to the device's clock frequency.
+         * @param device the device to communicate with
+         */
+        explicit Transaction(Device &device) : device(device) {
+            auto requested = esp_timer_get_time();
+            device.bus.lock();
+            start = esp_timer_get_time();
+            device.stats.maxWaitUs = max(device.stats.maxWaitUs, (uint32_t) (start - requested));
+            device.bus.useClock(device.frequency);
+        }
+
+        /**
+         * @brief Records the transaction's statistics and releases the bus.
+         */
+        ~Transaction() {
+            auto duration = (uint32_t) (esp_timer_get_time() - start);
+            auto &stats = device.stats;
+            stats.transactions++;
+            stats.totalUs += duration;
+            stats.maxUs = max(stats.maxUs, duration);
+            device.bus.unlock();
+        }
+
+        /**
+         * @return the wire of the bus, to be used while the transaction is alive
+         */
+        TwoWire &wire() const { return device.bus.wire; }
+
+        /**
+         * @brief Starts a transmission to the device.
+         */
+        void beginTransmission() const { device.bus.wire.beginTransmission(device.address); }
+
+        /**
+         * @brief Ends a transmission to the device, counting its bytes and NACKs.
+         * @param bytes the number of bytes written
+         * @param sendStop whether to send a stop condition
+         * @return the result of the transmission; 0 on success
+         */
+        uint8_t endTransmission(size_t bytes, bool sendStop = true) const {
+            auto result = device.bus.wire.endTransmission(sendStop);
+            device.stats.bytes += bytes;
+            if (result != 0) device.stats.nacks++;
+            return result;
+        }
+
+        // delete copy constructor and assignment operator
+
+        Transaction(const Transaction &) = delete;
+
+        Transaction &operator=(const Transaction &) = delete;
+
+    };
+
+    /**
+     * @brief Creates the bus.
+     * @param wire the wire of the bus
+     */
+    explicit I2CBus(TwoWire &wire = Wire) : wire(wire), mutex(xSemaphoreCreateRecursiveMutex()) {
+        assert(mutex != nullptr && "Could not create I2C bus mutex");
+    }
+
+    /**
+     * @brief Initializes the bus; may be called multiple times.
+     * @param sda the SDA pin
+     * @param scl the SCL pin
+     */
+    void begin(int sda, int scl) {
+        lock();
+        wire.begin(sda, scl);
+        clock = 0;
+        unlock();
+    }
+
+    /**
+     * @return all devices registered on the bus
+     */
+    const std::vector<Device *> &getDevices() const { return devices; }
+
+    // delete copy constructor and assignment operator
+
+    I2CBus(const I2CBus &) = delete;
+
+    I2CBus &operator=(const I2CBus &) = delete;
+
+private:
+
+    TwoWire &wire;
+    const SemaphoreHandle_t mutex;
+    uint32_t clock{0};
+    std::vector<Device *> devices{};
+
+    void lock() { xSemaphoreTakeRecursive(mutex, portMAX_DELAY); }
+
+    void unlock() { xSemaphoreGiveRecursive(mutex); }
+
+    void useClock(uint32_t frequency) {
+        if (clock == frequency) return;
+        wire.setClock(frequency);
+        clock = frequency;
+    }
+
+};
+
+
+#endif //ESP32_I2C_BUS_HPP
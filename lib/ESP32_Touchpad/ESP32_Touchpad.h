@@ -6,6 +6,7 @@
 #define ESP32_TOUCHPAD_H
 
 #include <Arduino.h>
+#include <driver/touch_pad.h>
 #include <AveragedValue.h>
 #include "ESP32_Touchpad.hpp"
 
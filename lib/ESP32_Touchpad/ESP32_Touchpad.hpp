@@ -7,51 +7,85 @@
 
 
 /**
- * @brief A class for reading one of the touch-capacitive pins of the ESP32.\n
- * The pin is read multiple times to get a good average value.
- * The class also provides a method to check if the pin is touched.
+ * @brief A class for one of the touch-capacitive pins of the ESP32.\n
+ * The pin is scanned by the touch hardware FSM, which raises an interrupt while the pin's value is below the threshold.
+ * The threshold is derived from the baseline, an averaged value of multiple readings while the pin is not touched,
+ * which can be restored from a previous calibration and is adjusted to slow drifts.
  */
 class Touchpad {
 
 private:
     constexpr static auto READINGS = 10;
+    constexpr static auto QUICK_READINGS = 3;
     constexpr static auto TOLERANCE = 0.9f;
 
     const uint8_t pin;
-    AveragedValue<float, READINGS> value{};
+    AveragedValue<float, READINGS> baseline{};
     float threshold{};
 
-    void touchRead() {
-        float val;
+    uint16_t touchRead() const {
+        uint16_t val;
         while ((val = ::touchRead(pin)) == 0);
-        value = val;
+        return val;
+    }
+
+    /**
+     * @brief Checks a stored baseline against a quick reading.
+     * A reading below the stored baseline is expected if the pin is touched while booting, so the stored baseline is kept;
+     * a reading much higher than the stored baseline means the environment changed and the pin needs to be recalibrated.
+     */
+    bool isValid(uint16_t storedBaseline) const {
+        float reading{0};
+        for (int i = 0; i < QUICK_READINGS; ++i) reading += touchRead();
+        return reading / QUICK_READINGS <= storedBaseline / TOLERANCE;
     }
 
 public:
+    using InterruptCallback = void (*)(void *);
+
     explicit Touchpad(uint8_t pin) : pin{pin} {}
 
     /**
-     * @brief Sets up the touch-capacitive pin.
-     * Reads the pin multiple times to get a good average value.
-     * Sets the threshold to the average value times the tolerance.
+     * @brief Sets up the touch-capacitive pin and attaches the interrupt.
+     * If a valid stored calibration is given, it is used instead of calibrating the pin with multiple readings.
+     * @param callback The callback to call from the touch ISR while the pin is touched; must reside in IRAM
+     * @param arg The argument to pass to the callback
+     * @param storedBaseline The baseline of a previous calibration or 0 to calibrate the pin
+     * @param storedThreshold The threshold of a previous calibration or 0 to derive it from the baseline
      */
-    void setup() {
-        for (int i = 0; i < READINGS; ++i) touchRead();
-        threshold = value * TOLERANCE;
+    void setup(InterruptCallback callback, void *arg, uint16_t storedBaseline = 0, uint16_t storedThreshold = 0) {
+        if (storedBaseline != 0 && isValid(storedBaseline)) {
+            baseline = storedBaseline;
+            threshold = storedThreshold != 0 ? storedThreshold : storedBaseline * TOLERANCE;
+        } else {
+            for (int i = 0; i < READINGS; ++i) baseline = touchRead();
+            threshold = baseline * TOLERANCE;
+        }
+        touchAttachInterruptArg(pin, callback, arg, (uint16_t) threshold);
     }
 
     /**
-     * @brief Reads the touch-capacitive pin and checks if its value is below the threshold.
-     * If the pin was not touched, the threshold is updated.
-     * @return True if the pin is touched, false otherwise.
+     * @brief Reads the touch-capacitive pin and updates the baseline and threshold to follow slow drifts of its value.
+     * Must only be called while the pin is not touched.
      */
-    bool isTouched() {
-        touchRead();
-        if (value < threshold) return true;
-        threshold = (threshold + value) / 2 * TOLERANCE;
-        return false;
+    void track() {
+        auto val = ::touchRead(pin);
+        if (val == 0 || val < threshold) return;
+        baseline = val;
+        threshold = baseline * TOLERANCE;
+        touch_pad_set_thresh((touch_pad_t) digitalPinToTouchChannel(pin), (uint16_t) threshold);
     }
 
+    /**
+     * @return The averaged value of the pin while not touched
+     */
+    uint16_t getBaseline() const { return (uint16_t) baseline; }
+
+    /**
+     * @return The value below which the pin counts as touched
+     */
+    uint16_t getThreshold() const { return (uint16_t) threshold; }
+
     Touchpad(const Touchpad &other) = delete;
 
     Touchpad &operator=(const Touchpad &other) = delete;
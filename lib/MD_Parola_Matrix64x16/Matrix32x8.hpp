@@ -29,6 +29,8 @@ namespace md_parola_matrix32x8 {
             TextSupplier textSupplier;
             Tab *prev;
             Tab *next;
+            std::string text; // the cached text of the supplier
+            uint32_t epoch; // the epoch the cached text was supplied in
         };
         bool setupDone{false};
         MD_Parola md;
@@ -36,14 +38,41 @@ namespace md_parola_matrix32x8 {
         std::vector<Tab> tabs;
         Tab *currentTab{nullptr};
         Tab *scrollTo{nullptr};
+        const Tab *shownTab{nullptr};
+        bool textChanged{false};
+        volatile uint32_t epoch{1};
         Animation lastAnimation{Animation::NONE};
 
+        /**
+         * @brief Updates the text buffer with the current tab's text.
+         * The text supplier is only called if the matrix was invalidated since the cached text was supplied
+         * and the text buffer is only set if the text or the tab changed.
+         */
+        void updateText() {
+            auto tab = currentTab;
+            auto currentEpoch = epoch;
+            if (tab->epoch != currentEpoch) {
+                tab->epoch = currentEpoch;
+                auto text = tab->textSupplier();
+                if (text != tab->text) {
+                    tab->text = std::move(text);
+                    // the text buffer may point to the replaced string
+                    if (shownTab == tab) shownTab = nullptr;
+                }
+            }
+            if (shownTab != tab) {
+                md.setTextBuffer(tab->text.c_str());
+                shownTab = tab;
+                textChanged = true;
+            }
+        }
+
     public:
 
         template<typename ...TextSuppliers>
         explicit Matrix32x8(uint8_t csPin, TextSuppliers...textSuppliers) : md(MD_MAX72XX::FC16_HW, csPin, 4) {
             for (const auto &ts: std::vector<TextSupplier>{textSuppliers...}) {
-                tabs.push_back(Tab{(uint8_t) tabs.size(), ts, nullptr, nullptr});
+                tabs.push_back(Tab{(uint8_t) tabs.size(), ts, nullptr, nullptr, {}, 0});
             }
             for (int i = 0; i < tabs.size(); ++i) {
                 tabs[i].prev = &tabs[(i - 1 + tabs.size()) % tabs.size()];
@@ -74,16 +103,18 @@ namespace md_parola_matrix32x8 {
 
         /**
          * @brief Sets the text to be displayed and controls the scrolling animation.
-         * This function is non-blocking and therefore should be called regularly.
-         * @param text The text to be displayed
+         * This function is non-blocking and therefore should be called regularly while the display is not idle.
+         * The text is only requested from the current tab's supplier if the matrix was invalidated.
+         * @return True if the display is idle, i.e. the current animation finished and no scrolling is pending
          */
-        void loop() {
+        bool loop() {
             assert(setupDone);
-            const std::string &string = currentTab->textSupplier();
-            md.setTextBuffer(string.c_str());
+            updateText();
             if (md.displayAnimate()) {
                 switch (animation) {
                     case Animation::NONE:
+                        // keep displaying the unchanged text instead of restarting the animation
+                        if (!textChanged) return true;
                         break;
                     case Animation::SCROLL_NEXT:
                         md.setTextEffect(PA_NO_EFFECT, PA_SCROLL_LEFT);
@@ -92,6 +123,7 @@ namespace md_parola_matrix32x8 {
                     case Animation::SCROLL_NEXT_ONGOING:
                         md.setTextEffect(PA_SCROLL_LEFT, PA_NO_EFFECT);
                         currentTab = scrollTo;
+                        updateText();
                         animation = Animation::SCROLL_FINISH;
                         break;
                     case Animation::SCROLL_PREV:
@@ -101,6 +133,7 @@ namespace md_parola_matrix32x8 {
                     case Animation::SCROLL_PREV_ONGOING:
                         md.setTextEffect(PA_SCROLL_RIGHT, PA_NO_EFFECT);
                         currentTab = scrollTo;
+                        updateText();
                         animation = Animation::SCROLL_FINISH;
                         break;
                     case Animation::SCROLL_FINISH:
@@ -109,20 +142,36 @@ namespace md_parola_matrix32x8 {
                         break;
                 }
                 md.displayReset();
+                textChanged = false;
+                return animation == Animation::NONE;
             }
+            return false;
         }
 
+        /**
+         * @brief Checks whether a scroll animation is pending or ongoing.
+         * @return True if the display is scrolling between tabs, false otherwise
+         */
+        bool isScrolling() const { return animation != Animation::NONE; }
+
         /**
          * @brief Overrides the text to be displayed, ignoring the text supplier and the scrolling animation.
          * @param text The text to be displayed
          */
         void overrideText(const char *text) {
             assert(setupDone);
+            shownTab = nullptr;
             md.setTextBuffer(text);
             md.displayReset();
             md.displayAnimate();
         }
 
+        /**
+         * @brief Invalidates the cached texts, so that the text suppliers are called again with the next loop.
+         * Should be called whenever the supplied texts might have changed, e.g. every second for a clock.
+         */
+        void invalidate() { epoch = epoch + 1; }
+
         /**
          * @brief Shutdowns the display.
          * @param shutdown True to shutdown the display, false to turn it on
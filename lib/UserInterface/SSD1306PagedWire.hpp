@@ -0,0 +1,180 @@
+#ifndef USER_INTERFACE_SSD1306_PAGED_WIRE_HPP
+#define USER_INTERFACE_SSD1306_PAGED_WIRE_HPP
+
+#ifndef OLEDDISPLAY_DOUBLE_BUFFER
+#error "SSD1306PagedWire needs the OLEDDisplay back buffer to detect changes"
+#endif
+
+
+namespace UserInterface {
+
+    /**
+     * @brief An I2C driver for SSD1306 displays only flushing the changed parts of the frame buffer\n
+     * The frame buffer is compared against the last flushed frame per display page (8 pixel rows);
+     * each page that changed is sent on its own, limited to the range of columns that changed.
+     * A frame without any change does not cause any I2C traffic.
+     * Each page is sent within its own transaction on the shared I2C bus, so other devices do not need to wait
+     * for a whole frame to be sent.\n
+     * Frames are flushed asynchronously: display() only copies the rendered frame into a pending buffer
+     * and a flush task pinned to the other core sends it while the next frame is rendered.
+     * If frames are rendered faster than they can be sent, only the latest pending frame is sent.
+     */
+    class SSD1306PagedWire : public OLEDDisplay {
+
+        static constexpr uint8_t MAX_PAGES = 8;
+        // the ESP32 Wire buffer holds 128 bytes including the control byte
+        static constexpr uint8_t CHUNK_SIZE = 127;
+        static constexpr BaseType_t FLUSH_TASK_CORE = 0;
+        static constexpr UBaseType_t FLUSH_TASK_PRIORITY = 2;
+
+        I2CBus::Device &device;
+        const int sda;
+        const int scl;
+        volatile uint32_t bytesSent{0};
+        std::vector<uint8_t> pending{}; // the latest rendered frame, guarded by the mutex
+        std::vector<uint8_t> frame{}; // the frame being sent, owned by the flush task
+        bool hasPending{false};
+        SemaphoreHandle_t mutex{nullptr};
+        TaskHandle_t flushTask{nullptr};
+
+        /**
+         * @brief Sends a command stream to the display within a single I2C transmission
+         * @param transaction the transaction to send the commands in
+         * @param commands the commands to send
+         * @param count the number of commands
+         */
+        void sendCommands(const I2CBus::Transaction &transaction, const uint8_t *commands, uint8_t count) {
+            transaction.beginTransmission();
+            transaction.wire().write(0x00); // control byte: command stream
+            transaction.wire().write(commands, count);
+            transaction.endTransmission(count + 1);
+            bytesSent += count + 1;
+        }
+
+        /**
+         * @brief Sends the given columns of a page to the display
+         * @param page the page to send
+         * @param from the first column to send
+         * @param to the last column to send
+         */
+        void sendPage(uint8_t page, uint8_t from, uint8_t to) {
+            const uint8_t xOffset = (128 - width()) / 2;
+            const uint8_t commands[] = {
+                    COLUMNADDR, (uint8_t) (xOffset + from), (uint8_t) (xOffset + to),
+                    PAGEADDR, page, page
+            };
+            I2CBus::Transaction transaction{device};
+            sendCommands(transaction, commands, sizeof(commands));
+            const uint8_t *data = frame.data() + page * width();
+            for (uint16_t x = from; x <= to; x += CHUNK_SIZE) {
+                auto length = (uint8_t) min((uint16_t) CHUNK_SIZE, (uint16_t) (to - x + 1));
+                transaction.beginTransmission();
+                transaction.wire().write(0x40); // control byte: data stream
+                transaction.wire().write(data + x, length);
+                transaction.endTransmission(length + 1);
+                bytesSent += length + 1;
+            }
+        }
+
+    protected:
+
+        int getBufferOffset() override { return 0; }
+
+        void sendCommand(uint8_t command) override {
+            I2CBus::Transaction transaction{device};
+            sendCommands(transaction, &command, 1);
+        }
+
+    public:
+
+        /**
+         * @brief Creates the driver
+         * @param device the display's device on the I2C bus; defines the address and clock frequency
+         * @param sda the SDA pin or -1 if the bus is already initialized
+         * @param scl the SCL pin or -1 if the bus is already initialized
+         */
+        SSD1306PagedWire(I2CBus::Device &device, int sda, int scl) : device(device), sda(sda), scl(scl) {
+            setGeometry(GEOMETRY_128_64);
+        }
+
+        bool connect() override {
+            if (sda != -1) device.getBus().begin(sda, scl);
+            if (flushTask != nullptr) return true;
+            pending.resize(displayBufferSize);
+            frame.resize(displayBufferSize);
+            mutex = xSemaphoreCreateMutex();
+            if (mutex == nullptr) return false;
+            return xTaskCreatePinnedToCore(
+                    [](void *param) {
+                        auto *self = (SSD1306PagedWire *) param;
+                        for (;;) {
+                            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+                            self->flush();
+                        }
+                    },
+                    "oledFlush",
+                    2048,
+                    this,
+                    FLUSH_TASK_PRIORITY,
+                    &flushTask,
+                    FLUSH_TASK_CORE
+            ) == pdPASS;
+        }
+
+        /**
+         * @brief Hands the rendered frame to the flush task without waiting for it to be sent
+         */
+        void display() override {
+            xSemaphoreTake(mutex, portMAX_DELAY);
+            memcpy(pending.data(), buffer, displayBufferSize);
+            hasPending = true;
+            xSemaphoreGive(mutex);
+            xTaskNotifyGive(flushTask);
+        }
+
+        /**
+         * @brief Sends all pages of the pending frame that changed since the last flushed frame to the display;
+         * called by the flush task
+         */
+        void flush() {
+            xSemaphoreTake(mutex, portMAX_DELAY);
+            bool hasFrame = hasPending;
+            if (hasFrame) pending.swap(frame);
+            hasPending = false;
+            xSemaphoreGive(mutex);
+            if (!hasFrame) return;
+
+            const auto pages = (uint8_t) min(height() / 8, (int) MAX_PAGES);
+            for (uint8_t page = 0; page < pages; ++page) {
+                uint8_t from = UINT8_MAX;
+                uint8_t to = 0;
+                auto offset = page * width();
+                for (uint8_t x = 0; x < width(); ++x) {
+                    if (frame[offset + x] != buffer_back[offset + x]) {
+                        if (from == UINT8_MAX) from = x;
+                        to = x;
+                        buffer_back[offset + x] = frame[offset + x];
+                    }
+                }
+                if (from != UINT8_MAX) sendPage(page, from, to);
+            }
+        }
+
+        /**
+         * @brief Get the number of bytes sent to the display since its creation, including control bytes
+         * @return the number of bytes sent
+         */
+        uint32_t getBytesSent() const { return bytesSent; }
+
+        // delete copy constructor and assignment operator
+
+        SSD1306PagedWire(const SSD1306PagedWire &) = delete;
+
+        SSD1306PagedWire &operator=(const SSD1306PagedWire &) = delete;
+
+    };
+
+}
+
+
+#endif //USER_INTERFACE_SSD1306_PAGED_WIRE_HPP
@@ -8,35 +8,92 @@
 
 namespace UserInterface {
 
+    /**
+     * @brief How often a frame needs to be redrawn while it is displayed
+     */
+    enum class Refresh {
+        OnChange, // only if the frame was invalidated, e.g. by user input
+        EverySecond, // on every tick of the clock and if the frame was invalidated
+        Animated // with the full target FPS
+    };
+
     class UIDisplay {
 
         using Handle = std::function<void(UIDisplay &)>;
 
-        SSD1306Wire oled;
+        static constexpr uint8_t TARGET_FPS = 30;
+        static constexpr uint32_t UPDATE_INTERVAL = 1000 / TARGET_FPS;
+
+        SSD1306PagedWire oled;
         OLEDDisplayUi ui{&oled};
         uint8_t cursor{0};
         std::vector<Handle> handles;
         std::vector<FrameCallback> callbacks;
+        std::vector<Refresh> refreshes;
+        volatile bool dirty{true};
+        bool sleeping{false};
+        uint32_t lastActivity{0};
+        uint32_t sleepTimeout;
 
         friend class UIGraphics;
 
+        /**
+         * @brief Get the refresh mode of the current frame
+         * @return the refresh mode of the current frame
+         */
+        Refresh currentRefresh() {
+            auto frame = ui.getUiState()->currentFrame;
+            return frame < refreshes.size() ? refreshes[frame] : Refresh::Animated;
+        }
+
+        /**
+         * @brief Check whether the display needs to be redrawn
+         * @return true if the display is transitioning, the current frame is animated,
+         *         was invalidated or its refresh interval elapsed
+         */
+        bool needsUpdate() {
+            auto state = ui.getUiState();
+            if (state->frameState != FIXED) return true;
+            if (sleeping) return false;
+            switch (currentRefresh()) {
+                case Refresh::OnChange:
+                case Refresh::EverySecond:
+                    return dirty;
+                case Refresh::Animated:
+                default:
+                    return true;
+            }
+        }
+
     public:
 
         OLEDDisplay &display = oled;
 
         /**
          * @brief A frame that can be displayed;
-         *       it consists of a callback that is called when the frame is displayed
-         *       and a handle that can be used process user input
+         *       it consists of a callback that is called when the frame is displayed,
+         *       a handle that can be used process user input and the frame's refresh mode
          */
         struct Frame {
             FrameCallback callback;
             Handle handle;
+            Refresh refresh;
+
+            Frame(FrameCallback callback, Handle handle, Refresh refresh = Refresh::OnChange)
+                    : callback(callback), handle(std::move(handle)), refresh(refresh) {}
         };
 
-        UIDisplay(uint8_t address, uint8_t sda, uint8_t scl) : oled(address, sda, scl) {
+        /**
+         * @brief Create the display
+         * @param device the display's device on the I2C bus
+         * @param sda the SDA pin
+         * @param scl the SCL pin
+         * @param sleepTimeout the inactivity in milliseconds after which the display is turned off
+         */
+        UIDisplay(I2CBus::Device &device, uint8_t sda, uint8_t scl, uint32_t sleepTimeout = 60000)
+                : oled(device, sda, scl), sleepTimeout(sleepTimeout) {
             oled.setFont(Roboto_Mono_Light_10);
-            ui.setTargetFPS(30);
+            ui.setTargetFPS(TARGET_FPS);
             ui.disableAllIndicators();
             ui.disableAutoTransition();
             ui.setFrameAnimation(SLIDE_LEFT);
@@ -52,7 +109,9 @@ namespace UserInterface {
         void setFrames(Frames ...frames) {
             handles = {frames.handle...};
             callbacks = {frames.callback...};
+            refreshes = {frames.refresh...};
             ui.setFrames(callbacks.data(), sizeof...(Frames));
+            wake();
         }
 
         /**
@@ -65,18 +124,84 @@ namespace UserInterface {
         }
 
         /**
-         * @brief Run UI updates and call the current frame's handle
+         * @brief Call the current frame's handle and redraw the display if needed;
+         *       turns the display off if there was no activity for the sleep timeout
+         *       and the current frame is not animated
          * @return true if the current frame is not animating
          */
         bool loop() {
-            if (ui.getUiState()->frameState == FIXED) {
-                auto frame = ui.getUiState()->currentFrame;
+            auto state = ui.getUiState();
+            if (state->frameState == FIXED) {
+                auto frame = state->currentFrame;
                 handles[frame](*this);
             }
-            ui.update();
-            return ui.getUiState()->frameState == FIXED;
+            if (needsUpdate()) {
+                auto lastUpdate = state->lastUpdate;
+                ui.update();
+                // the ui skips the update if the last one is less than the update interval ago
+                if (state->lastUpdate != lastUpdate) dirty = false;
+            }
+            if (!sleeping && state->frameState == FIXED && currentRefresh() != Refresh::Animated &&
+                millis() - lastActivity >= sleepTimeout) {
+                oled.displayOff();
+                sleeping = true;
+            }
+            return state->frameState == FIXED;
+        }
+
+        /**
+         * @brief Get the time until the display needs to be redrawn or turned off
+         * @return the time in milliseconds until the next call of loop() has work to do
+         */
+        uint32_t nextUpdateIn() {
+            auto state = ui.getUiState();
+            if (state->frameState != FIXED || dirty) return UPDATE_INTERVAL;
+            if (sleeping) return UINT32_MAX;
+            auto now = millis();
+            auto sinceActivity = (uint32_t) (now - lastActivity);
+            uint32_t untilSleep = sinceActivity >= sleepTimeout ? 0 : sleepTimeout - sinceActivity;
+            switch (currentRefresh()) {
+                case Refresh::OnChange:
+                case Refresh::EverySecond:
+                    return untilSleep;
+                case Refresh::Animated:
+                default:
+                    return UPDATE_INTERVAL;
+            }
+        }
+
+        /**
+         * @brief Mark the current frame as changed so that it is redrawn with the next loop
+         */
+        void invalidate() { dirty = true; }
+
+        /**
+         * @brief Mark the current frame as changed if it is refreshed every second;
+         *       should be called on every tick of the clock, so the frame's seconds change in phase with it
+         */
+        void tick() {
+            if (currentRefresh() == Refresh::EverySecond) invalidate();
         }
 
+        /**
+         * @brief Turn the display back on if it was turned off, reset the inactivity timeout
+         *       and redraw the current frame
+         */
+        void wake() {
+            lastActivity = millis();
+            if (sleeping) {
+                oled.displayOn();
+                sleeping = false;
+            }
+            invalidate();
+        }
+
+        /**
+         * @brief Check whether the display was turned off due to inactivity
+         * @return true if the display is turned off
+         */
+        bool isSleeping() const { return sleeping; }
+
         /**
          * @brief Draw an animated progress bar with a message and the progress percentage
          * @param progress the current progress in percent 0-100
@@ -101,19 +226,23 @@ namespace UserInterface {
         }
 
         /**
-         * @brief Transition to a new frame and reset the cursor to 0
+         * @brief Transition to a new frame, reset the cursor to 0 and wake the display
          * @param frame the new frame
          */
         void transitionToFrame(uint8_t frame) {
             ui.transitionToFrame(frame);
             cursor = 0;
+            wake();
         }
 
         /**
-         * @brief Set the current cursor value
+         * @brief Set the current cursor value and redraw the current frame
          * @param value the new cursor value
          */
-        void setCursor(uint8_t value) { cursor = value; }
+        void setCursor(uint8_t value) {
+            cursor = value;
+            invalidate();
+        }
 
         /**
          * @brief Get the current cursor value
@@ -109,7 +109,7 @@ namespace UserInterface {
         void drawSetter(
                 Line line,
                 const String &title,
-                uint8_t value,
+                uint16_t value,
                 const String &unit = {},
                 OLEDDISPLAY_TEXT_ALIGNMENT textAlignment = TEXT_ALIGN_LEFT
         ) const {
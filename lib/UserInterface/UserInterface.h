@@ -6,15 +6,19 @@
 #define USER_INTERFACE_DISPLAY_H
 
 #include <array>
+#include <vector>
 #include <Arduino.h>
 #include <Wire.h>
+#include <ESP32_I2CBus.h>
 #include "SSD1306.h"
 #include "OLEDDisplayUi.h"
 #include "font.h"
+#include "SSD1306PagedWire.hpp"
 #include "UIDisplay.hpp"
 #include "UIGraphics.hpp"
 
 using UserInterface::UIDisplay;
 using UserInterface::UIGraphics;
+using UserInterface::Refresh;
 
 #endif //USER_INTERFACE_DISPLAY_H
@@ -0,0 +1,172 @@
+#ifndef NATIVE_SHIM_ARDUINO_H
+#define NATIVE_SHIM_ARDUINO_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include "FreeRTOS.h"
+
+/**
+ * A minimal stand-in for the Arduino core used by the platform independent parts, so they can run on the host\n
+ * Only the parts of String, Print and Stream used by the alarm clock and ArduinoJson are provided.
+ */
+
+#define BIT0 0x00000001
+#define BIT1 0x00000002
+#define BIT2 0x00000004
+#define BIT3 0x00000008
+#define BIT4 0x00000010
+#define BIT5 0x00000020
+#define BIT6 0x00000040
+#define BIT7 0x00000080
+
+using std::min;
+using std::max;
+
+inline uint32_t esp_random() {
+    static std::mt19937 generator{42}; // fixed, so benchmarks are repeatable
+    return (uint32_t) generator();
+}
+
+class String {
+
+    std::string value;
+
+public:
+
+    String() = default;
+
+    String(const char *value) : value(value ? value : "") {} // NOLINT(google-explicit-constructor)
+
+    explicit String(char c) : value(1, c) {}
+
+    explicit String(int number) : value(std::to_string(number)) {}
+
+    explicit String(unsigned int number) : value(std::to_string(number)) {}
+
+    explicit String(long number) : value(std::to_string(number)) {}
+
+    explicit String(unsigned long number) : value(std::to_string(number)) {}
+
+    explicit String(unsigned char number) : value(std::to_string(number)) {}
+
+    String &operator=(const char *other) {
+        value = other ? other : "";
+        return *this;
+    }
+
+    const char *c_str() const { return value.c_str(); }
+
+    unsigned int length() const { return (unsigned int) value.length(); }
+
+    bool reserve(unsigned int size) {
+        value.reserve(size);
+        return true;
+    }
+
+    bool concat(const char *other) {
+        if (other) value += other;
+        return true;
+    }
+
+    bool concat(char c) {
+        value += c;
+        return true;
+    }
+
+    String &operator+=(const String &other) {
+        value += other.value;
+        return *this;
+    }
+
+    String &operator+=(const char *other) {
+        concat(other);
+        return *this;
+    }
+
+    String &operator+=(char c) {
+        value += c;
+        return *this;
+    }
+
+    char operator[](unsigned int i) const { return value[i]; }
+
+    int indexOf(char c, unsigned int from = 0) const {
+        auto i = value.find(c, from);
+        return i == std::string::npos ? -1 : (int) i;
+    }
+
+    String substring(unsigned int from, unsigned int to) const {
+        return String(value.substr(from, to - from).c_str());
+    }
+
+    void trim() {
+        auto begin = value.find_first_not_of(" \t\r\n");
+        auto end = value.find_last_not_of(" \t\r\n");
+        value = begin == std::string::npos ? "" : value.substr(begin, end - begin + 1);
+    }
+
+    long toInt() const { return std::strtol(value.c_str(), nullptr, 10); }
+
+    bool operator==(const String &other) const { return value == other.value; }
+
+    bool operator!=(const String &other) const { return value != other.value; }
+
+    bool operator==(const char *other) const { return value == (other ? other : ""); }
+
+    bool operator!=(const char *other) const { return !(*this == other); }
+
+    friend String operator+(String a, const String &b) { return a += b; }
+
+    friend String operator+(String a, const char *b) { return a += b; }
+
+    friend String operator+(const char *a, const String &b) { return String(a) += b; }
+
+    friend String operator+(String a, char b) { return a += b; }
+
+};
+
+class StringSumHelper : public String {};
+
+class Print {
+
+public:
+
+    virtual ~Print() = default;
+
+    virtual size_t write(uint8_t c) = 0;
+
+    virtual size_t write(const uint8_t *buffer, size_t size) {
+        size_t written = 0;
+        while (written < size && write(buffer[written])) ++written;
+        return written;
+    }
+
+};
+
+class Stream : public Print {
+
+public:
+
+    virtual int available() = 0;
+
+    virtual int read() = 0;
+
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long) {}
+
+    size_t readBytes(char *buffer, size_t length) {
+        size_t count = 0;
+        int c;
+        while (count < length && (c = read()) >= 0) buffer[count++] = (char) c;
+        return count;
+    }
+
+};
+
+#endif //NATIVE_SHIM_ARDUINO_H
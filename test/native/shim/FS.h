@@ -0,0 +1,108 @@
+#ifndef NATIVE_SHIM_FS_H
+#define NATIVE_SHIM_FS_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Arduino.h"
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+    using Content = std::shared_ptr<std::vector<uint8_t>>;
+
+    /**
+     * A file of the in-memory file system; reads and writes the shared content of the file at its own position
+     */
+    class File : public Stream {
+
+        Content content{};
+        size_t position{0};
+
+    public:
+
+        File() = default;
+
+        File(Content content, size_t position) : content(std::move(content)), position(position) {}
+
+        explicit operator bool() const { return content != nullptr; }
+
+        size_t size() const { return content ? content->size() : 0; }
+
+        bool seek(uint32_t to) {
+            if (!content || to > content->size()) return false;
+            position = to;
+            return true;
+        }
+
+        int available() override { return content ? (int) (content->size() - position) : 0; }
+
+        int read() override { return available() > 0 ? (*content)[position++] : -1; }
+
+        int peek() override { return available() > 0 ? (*content)[position] : -1; }
+
+        size_t read(uint8_t *buffer, size_t size) {
+            auto count = min(size, (size_t) available());
+            if (count) memcpy(buffer, content->data() + position, count);
+            position += count;
+            return count;
+        }
+
+        size_t write(uint8_t c) override { return write(&c, 1); }
+
+        size_t write(const uint8_t *buffer, size_t size) override {
+            if (!content) return 0;
+            if (position + size > content->size()) content->resize(position + size);
+            memcpy(content->data() + position, buffer, size);
+            position += size;
+            return size;
+        }
+
+        void close() { content.reset(); }
+
+    };
+
+    /**
+     * A file system keeping its files in RAM; like SPIFFS, a file cannot be renamed to an existing file
+     */
+    class FS {
+
+        std::map<std::string, Content> files{};
+
+    public:
+
+        File open(const char *path, const char *mode = FILE_READ) {
+            auto entry = files.find(path);
+            if (mode[0] == 'r') return entry == files.end() ? File{} : File{entry->second, 0};
+            if (mode[0] == 'w' || entry == files.end()) {
+                files[path] = std::make_shared<std::vector<uint8_t>>();
+                entry = files.find(path);
+            }
+            return File{entry->second, entry->second->size()};
+        }
+
+        bool exists(const char *path) const { return files.count(path) != 0; }
+
+        bool remove(const char *path) { return files.erase(path) != 0; }
+
+        bool rename(const char *from, const char *to) {
+            auto entry = files.find(from);
+            if (entry == files.end() || files.count(to)) return false;
+            files[to] = entry->second;
+            files.erase(from);
+            return true;
+        }
+
+        void format() { files.clear(); }
+
+    };
+
+}
+
+using fs::File;
+
+#endif //NATIVE_SHIM_FS_H
@@ -0,0 +1,80 @@
+#ifndef NATIVE_SHIM_FREERTOS_H
+#define NATIVE_SHIM_FREERTOS_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * A minimal stand-in for the FreeRTOS API used by the platform independent parts, so they can run on the host\n
+ * Host threads cannot be kept from being preempted, so suspending the scheduler is only counted,
+ * which lets tests check that it is suspended and resumed in pairs.
+ */
+
+typedef int32_t BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+typedef std::recursive_timed_mutex *SemaphoreHandle_t;
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+#define pdTRUE ((BaseType_t) 1)
+#define pdFALSE ((BaseType_t) 0)
+#define pdPASS pdTRUE
+#define portMAX_DELAY ((TickType_t) 0xFFFFFFFF)
+
+/**
+ * The number of times the scheduler was suspended and not resumed yet, or negative if resumed too often
+ */
+inline std::atomic<int32_t> &schedulerSuspensions() {
+    static std::atomic<int32_t> suspensions{0};
+    return suspensions;
+}
+
+/**
+ * The number of times the scheduler was suspended in total
+ */
+inline std::atomic<uint32_t> &schedulerSuspendCalls() {
+    static std::atomic<uint32_t> calls{0};
+    return calls;
+}
+
+inline void vTaskSuspendAll() {
+    schedulerSuspensions()++;
+    schedulerSuspendCalls()++;
+}
+
+inline BaseType_t xTaskResumeAll() {
+    schedulerSuspensions()--;
+    return pdFALSE;
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return new std::recursive_timed_mutex{}; }
+
+inline BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t mutex, TickType_t) {
+    mutex->lock();
+    return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t mutex) {
+    mutex->unlock();
+    return pdTRUE;
+}
+
+/**
+ * Tasks are not run, as the host tests drive the code directly; the handle only refers to the notifications
+ * the task would have received
+ */
+inline BaseType_t xTaskCreate(TaskFunction_t, const char *, uint32_t, void *, UBaseType_t, TaskHandle_t *handle) {
+    if (handle) *handle = new std::atomic<uint32_t>{0};
+    return pdPASS;
+}
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    ++*static_cast<std::atomic<uint32_t> *>(task);
+    return pdPASS;
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) { return 0; }
+
+#endif //NATIVE_SHIM_FREERTOS_H
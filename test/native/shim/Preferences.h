@@ -0,0 +1,74 @@
+#ifndef NATIVE_SHIM_PREFERENCES_H
+#define NATIVE_SHIM_PREFERENCES_H
+
+#include <map>
+#include <string>
+#include "Arduino.h"
+
+/**
+ * A stand-in for the ESP32's preferences keeping all values in RAM
+ */
+class Preferences {
+
+    std::map<std::string, uint32_t> numbers{};
+    std::map<std::string, std::string> strings{};
+
+    uint32_t getNumber(const char *key, uint32_t defaultValue) const {
+        auto entry = numbers.find(key);
+        return entry == numbers.end() ? defaultValue : entry->second;
+    }
+
+    size_t putNumber(const char *key, uint32_t value, size_t size) {
+        numbers[key] = value;
+        return size;
+    }
+
+public:
+
+    bool begin(const char *, bool = false) { return true; }
+
+    void end() {}
+
+    bool isKey(const char *key) const { return numbers.count(key) || strings.count(key); }
+
+    bool remove(const char *key) { return numbers.erase(key) + strings.erase(key) > 0; }
+
+    bool clear() {
+        numbers.clear();
+        strings.clear();
+        return true;
+    }
+
+    uint8_t getUChar(const char *key, uint8_t defaultValue = 0) const {
+        return (uint8_t) getNumber(key, defaultValue);
+    }
+
+    size_t putUChar(const char *key, uint8_t value) { return putNumber(key, value, sizeof(value)); }
+
+    uint16_t getUShort(const char *key, uint16_t defaultValue = 0) const {
+        return (uint16_t) getNumber(key, defaultValue);
+    }
+
+    size_t putUShort(const char *key, uint16_t value) { return putNumber(key, value, sizeof(value)); }
+
+    uint32_t getUInt(const char *key, uint32_t defaultValue = 0) const { return getNumber(key, defaultValue); }
+
+    size_t putUInt(const char *key, uint32_t value) { return putNumber(key, value, sizeof(value)); }
+
+    bool getBool(const char *key, bool defaultValue = false) const { return getNumber(key, defaultValue) != 0; }
+
+    size_t putBool(const char *key, bool value) { return putNumber(key, value, sizeof(value)); }
+
+    String getString(const char *key, const String &defaultValue = String()) const {
+        auto entry = strings.find(key);
+        return entry == strings.end() ? defaultValue : String(entry->second.c_str());
+    }
+
+    size_t putString(const char *key, const String &value) {
+        strings[key] = value.c_str();
+        return value.length() + 1;
+    }
+
+};
+
+#endif //NATIVE_SHIM_PREFERENCES_H
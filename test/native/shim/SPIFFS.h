@@ -0,0 +1,11 @@
+#ifndef NATIVE_SHIM_SPIFFS_H
+#define NATIVE_SHIM_SPIFFS_H
+
+#include "FS.h"
+
+/**
+ * The SPIFFS file system, kept in RAM on the host; each test is a single translation unit
+ */
+static fs::FS SPIFFS{};
+
+#endif //NATIVE_SHIM_SPIFFS_H
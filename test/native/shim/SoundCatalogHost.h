@@ -0,0 +1,50 @@
+#ifndef NATIVE_SHIM_SOUND_CATALOG_HOST_H
+#define NATIVE_SHIM_SOUND_CATALOG_HOST_H
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <Arduino.h>
+#include <Preferences.h>
+#include <SPIFFS.h>
+#include <ArduinoJson.h>
+
+/**
+ * Includes the sound catalog the way AlarmClock.h does, with the parts of the player it refers to;
+ * the player itself needs the ESP32's UART
+ */
+
+struct DFPlayerAsync {
+    static constexpr uint8_t LARGE_FOLDERS = 15; // the folders a track beyond 255 can be played from
+    static constexpr uint16_t LARGE_FOLDER_TRACKS = 3000;
+};
+
+#include "constants.h"
+#include "Bean.hpp"
+#include "Sound.hpp"
+
+namespace AlarmClock {
+
+    struct Player {
+
+        static constexpr uint8_t MAX_FOLDERS = 99;
+
+        struct Catalog {
+            uint16_t files{0};
+            uint8_t folders{0};
+            uint8_t lastFolder{0};
+            std::array<uint16_t, MAX_FOLDERS> folderFiles{};
+        };
+
+    };
+
+}
+
+#include "ShuffleBag.hpp"
+#include "MemoryStream.hpp"
+#include "SoundCatalog.hpp"
+
+#endif //NATIVE_SHIM_SOUND_CATALOG_HOST_H
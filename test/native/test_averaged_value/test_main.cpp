@@ -0,0 +1,155 @@
+#include <chrono>
+#include <cstdio>
+#include <unity.h>
+#include <AveragedValue.h>
+
+/**
+ * The number of updates each filter is benchmarked with
+ */
+constexpr size_t BENCHMARK_UPDATES = 1000000;
+
+/**
+ * The window sizes of the touchpad baseline and the light sensor
+ */
+constexpr size_t TOUCHPAD_READINGS = 10;
+constexpr size_t LIGHT_SENSOR_READINGS = 15;
+
+/**
+ * A copy of the AveragedValue before the ring buffer, shifting and summing the whole window on every update,
+ * as the baseline of the benchmark
+ */
+template<typename T, size_t n>
+class ShiftingAveragedValue {
+
+    T value{};
+    std::array<T, n> values{};
+    size_t initialReads{n};
+
+public:
+    T get() const { return value; }
+
+    void update(T newValue) {
+        if (initialReads > 0) {
+            for (size_t i = n - initialReads; i < n; ++i) values[i] = newValue;
+            initialReads--;
+        } else {
+            std::copy(std::begin(values) + 1, std::end(values), std::begin(values));
+            values[n - 1] = newValue;
+        }
+        value = std::accumulate(std::begin(values), std::end(values), (T) 0.0) / n;
+    }
+};
+
+/**
+ * A pseudo random sensor reading; a xorshift generator, so the benchmark does not measure the standard library
+ */
+uint32_t nextReading(uint32_t &state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state % 4096;
+}
+
+/**
+ * Benchmarks updating an averaged value
+ * @tparam Averaged The averaged value to benchmark
+ * @return The time per update in ns
+ */
+template<typename Averaged>
+double benchmark() {
+    Averaged averaged{};
+    uint32_t state{42};
+    volatile float sink{0};
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < BENCHMARK_UPDATES; ++i) {
+        averaged.update((float) nextReading(state));
+        sink = sink + averaged.get();
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return elapsed / BENCHMARK_UPDATES;
+}
+
+/**
+ * Benchmarks the filters against the shifting baseline at the given window size and prints the times per update
+ * @tparam n The window size
+ * @param name The name of the user of the window size printed with the result
+ */
+template<size_t n>
+void benchmarkWindow(const char *name) {
+    auto shifting = benchmark<ShiftingAveragedValue<float, n>>();
+    auto mean = benchmark<AveragedValue<float, n>>();
+    auto exponential = benchmark<AveragedValue<float, n, filter::Exponential>>();
+    auto minMax = benchmark<AveragedValue<float, n, filter::MinMax>>();
+    char message[160];
+    snprintf(message, sizeof(message),
+             "%-12s n=%2zu: shifting %6.2f ns, mean %6.2f ns (%4.1fx), exponential %6.2f ns, min max %6.2f ns",
+             name, n, shifting, mean, shifting / mean, exponential, minMax);
+    TEST_MESSAGE(message);
+}
+
+void test_mean() {
+    AveragedValue<float, 4> averaged{};
+    averaged = 4;
+    TEST_ASSERT_EQUAL_FLOAT(4, averaged.get());
+    averaged = 8;
+    averaged = 8;
+    TEST_ASSERT_EQUAL_FLOAT(6, averaged.get());
+    averaged = 8;
+    averaged = 8;
+    TEST_ASSERT_EQUAL_FLOAT(8, averaged.get());
+}
+
+void test_median_suppresses_spikes() {
+    AveragedValue<int, 3, filter::Median> averaged{};
+    averaged = 10;
+    averaged = 1000;
+    TEST_ASSERT_EQUAL_INT(10, averaged.get());
+    averaged = 12;
+    TEST_ASSERT_EQUAL_INT(12, averaged.get());
+}
+
+void test_min_max() {
+    AveragedValue<int, 3, filter::MinMax> averaged{};
+    averaged = 5;
+    averaged = 1;
+    averaged = 9;
+    TEST_ASSERT_EQUAL_INT(1, averaged.getFilter().min());
+    TEST_ASSERT_EQUAL_INT(9, averaged.getFilter().max());
+    averaged = 7;
+    averaged = 8; // the minimum leaves the window
+    TEST_ASSERT_EQUAL_INT(7, averaged.getFilter().min());
+    averaged = 6; // the maximum leaves the window
+    TEST_ASSERT_EQUAL_INT(8, averaged.getFilter().max());
+}
+
+void test_shifting_baseline_matches_mean() {
+    ShiftingAveragedValue<float, LIGHT_SENSOR_READINGS> shifting{};
+    AveragedValue<float, LIGHT_SENSOR_READINGS> mean{};
+    uint32_t state{42};
+    for (size_t i = 0; i < 100; ++i) {
+        auto reading = (float) nextReading(state);
+        shifting.update(reading);
+        mean.update(reading);
+        // the shifting baseline fills the window differently, so both agree once it is full
+        if (i >= LIGHT_SENSOR_READINGS) TEST_ASSERT_FLOAT_WITHIN(0.01f, shifting.get(), mean.get());
+    }
+}
+
+void test_benchmark() {
+    benchmarkWindow<TOUCHPAD_READINGS>("Touchpad");
+    benchmarkWindow<LIGHT_SENSOR_READINGS>("LightSensor");
+    char message[80];
+    snprintf(message, sizeof(message), "%-12s n= 5: median %6.2f ns",
+             "Median", benchmark<AveragedValue<float, 5, filter::Median>>());
+    TEST_MESSAGE(message);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_mean);
+    RUN_TEST(test_median_suppresses_spikes);
+    RUN_TEST(test_min_max);
+    RUN_TEST(test_shifting_baseline_matches_mean);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,98 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <unity.h>
+#include <FreeRTOS.h>
+#include <SeqLock.hpp>
+
+/**
+ * The duration of the stress test
+ */
+constexpr auto STRESS_DURATION = std::chrono::milliseconds(500);
+
+/**
+ * A value spanning several words, so a torn read shows as words that differ
+ */
+struct Value {
+    uint32_t words[5]{7, 7, 7, 7, 7};
+};
+
+/**
+ * Constructing a SeqLock, e.g. during static initialization, must not touch the scheduler
+ */
+void test_construction_does_not_suspend_the_scheduler() {
+    auto calls = schedulerSuspendCalls().load();
+    SeqLock<Value> lock{};
+    TEST_ASSERT_EQUAL_UINT32(calls, schedulerSuspendCalls().load());
+    auto value = lock.load();
+    for (auto word: value.words) TEST_ASSERT_EQUAL_UINT32(7, word);
+}
+
+void test_store_and_load() {
+    SeqLock<Value> lock{};
+    Value value{};
+    for (uint32_t i = 0; i < 5; ++i) value.words[i] = i;
+    lock = value;
+    auto loaded = lock.load();
+    TEST_ASSERT_EQUAL_INT(0, memcmp(&value, &loaded, sizeof(Value)));
+    TEST_ASSERT_EQUAL_INT(0, schedulerSuspensions().load());
+}
+
+/**
+ * A single writer stores values whose words are all equal while several readers check that every snapshot
+ * is consistent and that the snapshots never go back in time
+ */
+void test_stress() {
+    SeqLock<Value> lock{};
+    std::atomic<bool> running{true};
+    std::atomic<uint32_t> torn{0};
+    std::atomic<uint32_t> reordered{0};
+    std::atomic<uint64_t> reads{0};
+
+    std::vector<std::thread> readers{};
+    auto cores = std::max(2u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < cores - 1; ++i) {
+        readers.emplace_back([&]() {
+            uint32_t last{0};
+            uint64_t count{0};
+            while (running.load(std::memory_order_relaxed)) {
+                auto value = lock.load();
+                for (auto word: value.words) if (word != value.words[0]) torn++;
+                if (value.words[0] != 7 && value.words[0] < last) reordered++;
+                if (value.words[0] != 7) last = value.words[0];
+                count++;
+            }
+            reads += count;
+        });
+    }
+
+    uint32_t writes{0};
+    auto end = std::chrono::steady_clock::now() + STRESS_DURATION;
+    while (std::chrono::steady_clock::now() < end) {
+        Value value{};
+        ++writes;
+        for (auto &word: value.words) word = writes + 7;
+        lock.store(value);
+    }
+    running = false;
+    for (auto &reader: readers) reader.join();
+
+    char message[80];
+    snprintf(message, sizeof(message), "%u writes, %llu reads", writes, (unsigned long long) reads.load());
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT32(0, torn.load());
+    TEST_ASSERT_EQUAL_UINT32(0, reordered.load());
+    TEST_ASSERT_EQUAL_INT(0, schedulerSuspensions().load());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_construction_does_not_suspend_the_scheduler);
+    RUN_TEST(test_store_and_load);
+    RUN_TEST(test_stress);
+    return UNITY_END();
+}
@@ -0,0 +1,149 @@
+#include <chrono>
+#include <cstdio>
+#include <unity.h>
+#include <SoundCatalogHost.h>
+
+using AlarmClock::SoundCatalog;
+
+/**
+ * The number of sounds the sounds API is benchmarked with
+ */
+constexpr uint16_t SOUND_COUNT = 255;
+
+/**
+ * The number of times each benchmark is repeated
+ */
+constexpr size_t BENCHMARK_RUNS = 20;
+
+/**
+ * The size of the chunks the array is sent in, about the size of a TCP segment
+ */
+constexpr size_t CHUNK_SIZE = 1436;
+
+Preferences preferences{};
+
+/**
+ * Imports sounds with names and addresses like the ones of a real SD card
+ * @param catalog The catalog to import the sounds into
+ */
+void importSounds(SoundCatalog &catalog) {
+    SPIFFS.format();
+    auto file = SPIFFS.open(JSON_SOUNDS_FILE_NAME, FILE_WRITE);
+    file.write('[');
+    for (uint16_t id = 1; id <= SOUND_COUNT; ++id) {
+        char sound[160];
+        auto length = snprintf(sound, sizeof(sound), R"(%s{"id":%u,"name":"Artist %u - Title of the sound",)"
+                                                     R"("allowRandom":%s,"folder":%u,"track":%u})",
+                               id == 1 ? "" : ",", id, id % 40, id % 3 ? "true" : "false", id / 100 + 1, id % 100);
+        file.write((const uint8_t *) sound, (size_t) length);
+    }
+    file.write(']');
+    file.close();
+    TEST_ASSERT_TRUE(catalog.load());
+    TEST_ASSERT_EQUAL(SOUND_COUNT, catalog.size());
+}
+
+/**
+ * Serializes all sounds in chunks, as the sounds API sends them
+ * @param catalog The catalog
+ * @param msgPack true for MessagePack, false for JSON
+ * @return The serialized array
+ */
+std::string encode(const SoundCatalog &catalog, bool msgPack) {
+    SoundCatalog::ArrayCursor cursor{0, SIZE_MAX, SoundCatalog::ALL_FIELDS, msgPack};
+    std::string encoded;
+    uint8_t chunk[CHUNK_SIZE];
+    size_t length;
+    while ((length = catalog.fillArray(chunk, sizeof(chunk), cursor)) != 0) {
+        encoded.append((const char *) chunk, length);
+    }
+    return encoded;
+}
+
+/**
+ * Deserializes the array of sounds as a client would
+ * @param doc The document to deserialize into
+ * @param encoded The serialized array
+ * @param msgPack true for MessagePack, false for JSON
+ * @return true if the array was deserialized, false otherwise
+ */
+bool decode(JsonDocument &doc, const std::string &encoded, bool msgPack) {
+    auto error = msgPack ? deserializeMsgPack(doc, encoded.data(), encoded.size())
+                         : deserializeJson(doc, encoded.data(), encoded.size());
+    return !error;
+}
+
+/**
+ * Measures the mean duration of the given function
+ * @return The mean duration in µs
+ */
+template<typename F>
+double measure(F function) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < BENCHMARK_RUNS; ++i) function();
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count()
+           / BENCHMARK_RUNS;
+}
+
+/**
+ * Benchmarks the size, encoding and decoding of the sounds array
+ * @param name The name printed with the result
+ * @param msgPack true for MessagePack, false for JSON
+ * @param size Set to the size of the serialized array
+ */
+void benchmark(const char *name, bool msgPack, size_t &size) {
+    SoundCatalog catalog{preferences};
+    importSounds(catalog);
+    auto encoded = encode(catalog, msgPack);
+    size = encoded.size();
+    auto encodeUs = measure([&catalog, msgPack]() { encode(catalog, msgPack); });
+
+    DynamicJsonDocument doc{JSON_ARRAY_SIZE(SOUND_COUNT) + SOUND_COUNT * JSON_OBJECT_SIZE(5) + encoded.size()};
+    TEST_ASSERT_TRUE(decode(doc, encoded, msgPack));
+    TEST_ASSERT_EQUAL(SOUND_COUNT, doc.as<JsonArray>().size());
+    TEST_ASSERT_EQUAL(SOUND_COUNT, doc[SOUND_COUNT - 1]["id"].as<uint16_t>());
+    TEST_ASSERT_TRUE(doc[SOUND_COUNT - 1]["name"].as<String>() == catalog.getName(SOUND_COUNT));
+    auto decodeUs = measure([&doc, &encoded, msgPack]() { decode(doc, encoded, msgPack); });
+
+    char message[120];
+    snprintf(message, sizeof(message), "%-12s %6zu bytes, encode %8.1f us, decode %8.1f us",
+             name, encoded.size(), encodeUs, decodeUs);
+    TEST_MESSAGE(message);
+}
+
+void test_benchmark() {
+    size_t jsonSize{0};
+    size_t msgPackSize{0};
+    benchmark("JSON", false, jsonSize);
+    benchmark("MessagePack", true, msgPackSize);
+    TEST_ASSERT_TRUE(msgPackSize < jsonSize);
+}
+
+/**
+ * A page of the array is complete in both formats
+ */
+void test_page() {
+    SoundCatalog catalog{preferences};
+    importSounds(catalog);
+    for (auto msgPack : {false, true}) {
+        SoundCatalog::ArrayCursor cursor{250, 10, SoundCatalog::FIELD_ID, msgPack};
+        std::string encoded;
+        uint8_t chunk[8];
+        size_t length;
+        while ((length = catalog.fillArray(chunk, sizeof(chunk), cursor)) != 0) {
+            encoded.append((const char *) chunk, length);
+        }
+        DynamicJsonDocument doc{1024};
+        TEST_ASSERT_TRUE(decode(doc, encoded, msgPack));
+        TEST_ASSERT_EQUAL(5, doc.as<JsonArray>().size());
+        TEST_ASSERT_EQUAL(251, doc[0]["id"].as<uint16_t>());
+        TEST_ASSERT_TRUE(doc[0]["name"].isNull());
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_benchmark);
+    RUN_TEST(test_page);
+    return UNITY_END();
+}
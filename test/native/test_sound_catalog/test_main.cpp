@@ -0,0 +1,280 @@
+#include <chrono>
+#include <cstdio>
+#include <unity.h>
+#include <SoundCatalogHost.h>
+
+using AlarmClock::SoundCatalog;
+
+/**
+ * The number of times each benchmark is repeated
+ */
+constexpr size_t BENCHMARK_RUNS = 20;
+
+Preferences preferences{};
+
+/**
+ * @return The name of the sound with the given id in the generated files
+ */
+String nameOf(uint16_t id) {
+    char name[32];
+    snprintf(name, sizeof(name), "Sound name %u", id);
+    return name;
+}
+
+/**
+ * Writes a JSON sounds file like the one the catalog is imported from
+ * @param fileName The name of the file
+ * @param count The number of sounds
+ * @return The size of the file
+ */
+size_t writeJson(const char *fileName, uint16_t count) {
+    auto file = SPIFFS.open(fileName, FILE_WRITE);
+    file.write('[');
+    for (uint16_t id = 1; id <= count; ++id) {
+        char sound[128];
+        auto length = snprintf(sound, sizeof(sound), R"(%s{"id":%u,"name":"%s","allowRandom":%s})",
+                               id == 1 ? "" : ",", id, nameOf(id).c_str(), id % 3 ? "true" : "false");
+        file.write((const uint8_t *) sound, (size_t) length);
+    }
+    file.write(']');
+    auto size = file.size();
+    file.close();
+    return size;
+}
+
+/**
+ * Parses a JSON sounds file one sound at a time, as the sounds were loaded before the binary catalog
+ * @param fileName The name of the file
+ * @return The number of parsed sounds
+ */
+size_t parseJson(const char *fileName) {
+    auto file = SPIFFS.open(fileName);
+    StaticJsonDocument<JSON_SOUND_BUF_SIZE> doc;
+    size_t count = 0;
+    if (file.read() != '[') return 0;
+    do {
+        if (deserializeJson(doc, file)) break;
+        if (doc["name"].as<String>().length() != 0) ++count;
+    } while (file.read() == ',');
+    file.close();
+    return count;
+}
+
+/**
+ * Measures the mean duration of the given function
+ * @return The mean duration in µs
+ */
+template<typename F>
+double measure(F function) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < BENCHMARK_RUNS; ++i) function();
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count()
+           / BENCHMARK_RUNS;
+}
+
+/**
+ * Benchmarks loading the sounds from the JSON file against loading them from the binary catalog
+ * @param count The number of sounds
+ */
+void benchmark(uint16_t count) {
+    SPIFFS.format();
+    auto jsonSize = writeJson(JSON_SOUNDS_FILE_NAME, count);
+    auto jsonUs = measure([]() { parseJson(JSON_SOUNDS_FILE_NAME); });
+    TEST_ASSERT_EQUAL(count, parseJson(JSON_SOUNDS_FILE_NAME));
+
+    SoundCatalog catalog{preferences};
+    TEST_ASSERT_TRUE(catalog.load()); // imports the JSON file
+    TEST_ASSERT_FALSE(SPIFFS.exists(JSON_SOUNDS_FILE_NAME));
+    auto binarySize = SPIFFS.open(SOUNDS_FILE_NAME).size();
+    auto binaryUs = measure([&catalog]() { catalog.load(); });
+    TEST_ASSERT_EQUAL(count, catalog.size());
+    TEST_ASSERT_TRUE(catalog.getName(count) == nameOf(count));
+
+    char message[120];
+    snprintf(message, sizeof(message), "%5u sounds: JSON %6zu bytes %9.1f us, binary %6zu bytes %9.1f us",
+             count, jsonSize, jsonUs, binarySize, binaryUs);
+    TEST_MESSAGE(message);
+}
+
+void test_benchmark_255() { benchmark(255); }
+
+void test_benchmark_2000() { benchmark(2000); }
+
+/**
+ * A malformed import, e.g. a name longer than 255 characters, keeps the current sounds
+ */
+void test_malformed_import_keeps_the_catalog() {
+    SPIFFS.format();
+    writeJson(JSON_SOUNDS_FILE_NAME, 10);
+    SoundCatalog catalog{preferences};
+    TEST_ASSERT_TRUE(catalog.load());
+
+    std::string json = R"([{"id":1,"name":")" + std::string(300, 'x') + R"("}])";
+    MemoryStream stream{(const uint8_t *) json.data(), json.size()};
+    TEST_ASSERT_FALSE(catalog.importJson(stream));
+    TEST_ASSERT_EQUAL(10, catalog.size());
+    TEST_ASSERT_TRUE(catalog.getName(10) == nameOf(10));
+}
+
+/**
+ * Sounds uploaded as MessagePack are imported like JSON ones, including the unknown keys that are skipped
+ */
+void test_import_msg_pack() {
+    SPIFFS.format();
+    SoundCatalog catalog{preferences};
+    const uint8_t msgPack[] = {
+            0x92, // [
+            0x83, 0xA2, 'i', 'd', 0x01, 0xA4, 'n', 'a', 'm', 'e', 0xA3, 'O', 'n', 'e',
+            0xA7, 'u', 'n', 'k', 'n', 'o', 'w', 'n', 0x92, 0x01, 0x02, // {"id":1,"name":"One","unknown":[1,2]}
+            0x84, 0xA2, 'i', 'd', 0x02, 0xA4, 'n', 'a', 'm', 'e', 0xA3, 'T', 'w', 'o',
+            0xA6, 'f', 'o', 'l', 'd', 'e', 'r', 0x03, 0xA5, 't', 'r', 'a', 'c', 'k', 0x07 // {"id":2,...,"track":7}
+    };
+    MemoryStream stream{msgPack, sizeof(msgPack)};
+    TEST_ASSERT_TRUE(catalog.importMsgPack(stream));
+    TEST_ASSERT_EQUAL(2, catalog.size());
+    TEST_ASSERT_TRUE(catalog.getName(1) == "One");
+    TEST_ASSERT_TRUE(catalog.getName(2) == "Two");
+    AlarmClock::Sound sound;
+    TEST_ASSERT_TRUE(catalog.find(2, sound));
+    TEST_ASSERT_EQUAL(3, sound.getFolder());
+    TEST_ASSERT_EQUAL(7, sound.getTrack());
+
+    const uint8_t truncated[] = {0x92, 0x81, 0xA2, 'i', 'd', 0x03};
+    MemoryStream truncatedStream{truncated, sizeof(truncated)};
+    TEST_ASSERT_FALSE(catalog.importMsgPack(truncatedStream));
+    TEST_ASSERT_EQUAL(2, catalog.size());
+}
+
+/**
+ * A name of 255 characters is imported completely
+ */
+void test_import_longest_name() {
+    SPIFFS.format();
+    auto file = SPIFFS.open(JSON_SOUNDS_FILE_NAME, FILE_WRITE);
+    std::string name(UINT8_MAX, 'x');
+    std::string json = R"([{"id":1,"name":")" + name + R"(","allowRandom":true,"unknown":[1,2,3]}])";
+    file.write((const uint8_t *) json.data(), json.size());
+    file.close();
+    SoundCatalog catalog{preferences};
+    TEST_ASSERT_TRUE(catalog.load());
+    TEST_ASSERT_TRUE(catalog.getName(1) == name.c_str());
+}
+
+/**
+ * Checks that the sound with the given id is addressed by the given folder and track
+ */
+void assertAddress(SoundCatalog &catalog, uint16_t id, uint8_t folder, uint16_t track) {
+    AlarmClock::Sound sound;
+    TEST_ASSERT_TRUE(catalog.find(id, sound));
+    TEST_ASSERT_EQUAL(folder, sound.getFolder());
+    TEST_ASSERT_EQUAL(track, sound.getTrack());
+}
+
+/**
+ * A file inserted into an early folder gets a new id, the sounds of the later files keep their ids and addresses,
+ * and sounds with an explicit address keep it
+ */
+void test_reconcile_keeps_addresses() {
+    SPIFFS.format();
+    SoundCatalog catalog{preferences};
+    std::string json = R"([{"id":1,"name":"Explicit","folder":2,"track":2},{"id":2,"name":"Global","track":7}])";
+    MemoryStream stream{(const uint8_t *) json.data(), json.size()};
+    TEST_ASSERT_TRUE(catalog.importJson(stream));
+
+    AlarmClock::Player::Catalog card{};
+    card.files = 10;
+    card.folders = 2;
+    card.lastFolder = 2;
+    card.folderFiles[0] = 3;
+    card.folderFiles[1] = 2;
+    TEST_ASSERT_TRUE(catalog.reconcile(card));
+    TEST_ASSERT_EQUAL(6, catalog.size());
+    assertAddress(catalog, 1, 2, 2);
+    assertAddress(catalog, 2, 0, 7);
+    assertAddress(catalog, 3, 1, 1);
+    assertAddress(catalog, 5, 1, 3);
+    assertAddress(catalog, 6, 2, 1);
+    TEST_ASSERT_FALSE(catalog.reconcile(card));
+
+    card.files = 11;
+    card.folderFiles[0] = 4;
+    TEST_ASSERT_TRUE(catalog.reconcile(card));
+    TEST_ASSERT_EQUAL(7, catalog.size());
+    assertAddress(catalog, 6, 2, 1);
+    assertAddress(catalog, 7, 1, 4);
+    TEST_ASSERT_TRUE(catalog.getName(1) == "Explicit");
+    TEST_ASSERT_TRUE(catalog.getName(2) == "Global");
+
+    card.files = 6;
+    card.folderFiles[1] = 1;
+    TEST_ASSERT_TRUE(catalog.reconcile(card));
+    AlarmClock::Sound sound;
+    TEST_ASSERT_TRUE(catalog.find(1, sound));
+    TEST_ASSERT_FALSE(sound.hasFile());
+    TEST_ASSERT_TRUE(catalog.find(2, sound));
+    TEST_ASSERT_FALSE(sound.hasFile());
+    TEST_ASSERT_TRUE(catalog.find(6, sound));
+    TEST_ASSERT_TRUE(sound.hasFile());
+}
+
+/**
+ * Every sound that may be played randomly is drawn once before any is repeated, also beyond 1024 sounds,
+ * and the order is continued by a catalog that loads the stored position
+ */
+void test_random_draws_all_sounds() {
+    SPIFFS.format();
+    writeJson(JSON_SOUNDS_FILE_NAME, 2000);
+    std::vector<bool> drawn(2001, false);
+    size_t eligible = 2000 - 2000 / 3; // every third sound is not allowed to be played randomly
+    AlarmClock::Sound sound;
+    {
+        SoundCatalog catalog{preferences};
+        TEST_ASSERT_TRUE(catalog.load());
+        for (size_t i = 0; i < eligible / 2; ++i) {
+            TEST_ASSERT_TRUE(catalog.findRandom(sound));
+            TEST_ASSERT_TRUE(sound.isAllowRandom());
+            TEST_ASSERT_FALSE(drawn[sound.getId()]);
+            drawn[sound.getId()] = true;
+        }
+        catalog.storeRandom();
+    }
+    SoundCatalog catalog{preferences};
+    TEST_ASSERT_TRUE(catalog.load());
+    for (size_t i = eligible / 2; i < eligible; ++i) {
+        TEST_ASSERT_TRUE(catalog.findRandom(sound));
+        TEST_ASSERT_TRUE(sound.isAllowRandom());
+        TEST_ASSERT_FALSE(drawn[sound.getId()]);
+        drawn[sound.getId()] = true;
+    }
+    TEST_ASSERT_TRUE(drawn[2000]); // beyond the first 1024 ids
+}
+
+/**
+ * A reset after the old catalog file was removed, but before the new one was renamed, loses no sounds
+ */
+void test_recover_interrupted_write() {
+    SPIFFS.format();
+    writeJson(JSON_SOUNDS_FILE_NAME, 10);
+    {
+        SoundCatalog catalog{preferences};
+        TEST_ASSERT_TRUE(catalog.load());
+    }
+    TEST_ASSERT_TRUE(SPIFFS.rename(SOUNDS_FILE_NAME, SOUNDS_TMP_FILE_NAME));
+    SoundCatalog catalog{preferences};
+    TEST_ASSERT_TRUE(catalog.load());
+    TEST_ASSERT_EQUAL(10, catalog.size());
+    TEST_ASSERT_FALSE(SPIFFS.exists(SOUNDS_TMP_FILE_NAME));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_benchmark_255);
+    RUN_TEST(test_benchmark_2000);
+    RUN_TEST(test_malformed_import_keeps_the_catalog);
+    RUN_TEST(test_import_msg_pack);
+    RUN_TEST(test_import_longest_name);
+    RUN_TEST(test_reconcile_keeps_addresses);
+    RUN_TEST(test_random_draws_all_sounds);
+    RUN_TEST(test_recover_interrupted_write);
+    return UNITY_END();
+}